@@ -130,7 +130,7 @@ void CraftsState::init()
 		ss << (*i)->getNumWeapons() << "/" << (*i)->getRules()->getWeapons();
 		ss2 << (*i)->getNumSoldiers();
 		ss3 << (*i)->getNumVehicles();
-		_lstCrafts->addRow(5, (*i)->getName(_game->getLanguage()).c_str(), _game->getLanguage()->getString((*i)->getStatus()).c_str(), ss.str().c_str(), ss2.str().c_str(), ss3.str().c_str());
+		_lstCrafts->addRow(5, (*i)->getName(_game->getLanguage()).c_str(), _game->getLanguage()->getString((*i)->getStatusString()).c_str(), ss.str().c_str(), ss2.str().c_str(), ss3.str().c_str());
 	}
 }
 
@@ -149,7 +149,7 @@ void CraftsState::btnOkClick(Action *)
  */
 void CraftsState::lstCraftsClick(Action *)
 {
-	if (_base->getCrafts()->at(_lstCrafts->getSelectedRow())->getStatus() != "STR_OUT")
+	if (_base->getCrafts()->at(_lstCrafts->getSelectedRow())->getStatus() != CRAFT_OUT)
 	{
 		_game->pushState(new CraftInfoState(_game, _base, _lstCrafts->getSelectedRow()));
 	}
@@ -101,6 +101,7 @@ void DismantleFacilityState::btnOkClick(Action *)
 			if (*i == _fac)
 			{
 				_base->getFacilities()->erase(i);
+				_base->facilitiesChanged();
 				delete _fac;
 				break;
 			}
@@ -83,6 +83,7 @@ void PlaceLiftState::viewClick(Action *)
 	fac->setX(_view->getGridX());
 	fac->setY(_view->getGridY());
 	_base->getFacilities()->push_back(fac);
+	_base->facilitiesChanged();
 	_game->popState();
 	BasescapeState *bState = new BasescapeState(_game, _base, _globe);
 	_game->pushState(bState);
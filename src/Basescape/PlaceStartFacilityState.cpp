@@ -75,6 +75,7 @@ void PlaceStartFacilityState::viewClick(Action *)
 		fac->setX(_view->getGridX());
 		fac->setY(_view->getGridY());
 		_base->getFacilities()->push_back(fac);
+		_base->facilitiesChanged();
 		_game->popState();
 		_select->FacilityBuilt();
 	}
@@ -140,7 +140,7 @@ SellState::SellState(Game *game, Base *base) : State(game), _base(base), _qtys()
 	}
 	for (std::vector<Craft*>::iterator i = _base->getCrafts()->begin(); i != _base->getCrafts()->end(); ++i)
 	{
-		if ((*i)->getStatus() != "STR_OUT")
+		if ((*i)->getStatus() != CRAFT_OUT)
 		{
 			_qtys.push_back(0);
 			_crafts.push_back(*i);
@@ -244,7 +244,7 @@ void SellState::btnOkClick(Action *)
 				}
 
 				// Remove items from craft
-				for (std::map<std::string, int>::iterator it = craft->getItems()->getContents()->begin(); it != craft->getItems()->getContents()->end(); ++it)
+				for (std::map<std::string, int>::const_iterator it = craft->getItems()->getContents()->begin(); it != craft->getItems()->getContents()->end(); ++it)
 				{
 					_base->getItems()->addItem(it->first, it->second);
 				}
@@ -264,6 +264,7 @@ void SellState::btnOkClick(Action *)
 					if (*c == craft)
 					{
 						_base->getCrafts()->erase(c);
+						_base->craftsChanged();
 						break;
 					}
 				}
@@ -132,7 +132,7 @@ TransferItemsState::TransferItemsState(Game *game, Base *baseFrom, Base *baseTo)
 	}
 	for (std::vector<Craft*>::iterator i = _baseFrom->getCrafts()->begin(); i != _baseFrom->getCrafts()->end(); ++i)
 	{
-		if ((*i)->getStatus() != "STR_OUT")
+		if ((*i)->getStatus() != CRAFT_OUT)
 		{
 			_qtys.push_back(0);
 			_crafts.push_back(*i);
@@ -281,6 +281,7 @@ void TransferItemsState::completeTransfer()
 						t->setCraft(*c);
 						_baseTo->getTransfers()->push_back(t);
 						_baseFrom->getCrafts()->erase(c);
+						_baseFrom->craftsChanged();
 						break;
 					}
 				}
@@ -151,7 +151,7 @@ void AggroBAIState::think(BattleAction *action)
 		exposed means they have been previously spotted, and are therefore "known" to the AI,
 		regardless of whether we can see them or not, because we're psychic.
 	*/
-	if (_unit->getStats()->psiSkill && _unit->getType() != "SOLDIER" && _game->getExposedUnits()->size() > 0 && RNG::generate(0, 100) > 66)
+	if (_unit->getStats()->psiSkill && _unit->getType() != "SOLDIER" && _game->getExposedUnits()->size() > 0 && RNG::generate(RNG::AI, 0, 100) > 66)
 	{
 		int psiAttackStrength = _unit->getStats()->psiSkill * _unit->getStats()->psiStrength / 50;
 		int chanceToAttack = 0;
@@ -165,7 +165,7 @@ void AggroBAIState::think(BattleAction *action)
 					+ ((*i)->getStats()->psiSkill * -0.4)
 					- (_game->getTileEngine()->distance(_unit->getPosition(), (*i)->getPosition()) / 2)
 					- ((*i)->getStats()->psiStrength)
-					+ (RNG::generate(0, 50))
+					+ (RNG::generate(RNG::AI, 0, 50))
 					+ 55;
 
 				if (chanceToAttackMe > chanceToAttack)
@@ -192,7 +192,7 @@ void AggroBAIState::think(BattleAction *action)
 			}
 			else
 			{
-				if (RNG::generate(35, 155) >= chanceToAttack)
+				if (RNG::generate(RNG::AI, 35, 155) >= chanceToAttack)
 				{
 					chanceToAttack = 0;
 					_aggroTarget = 0;
@@ -220,7 +220,7 @@ void AggroBAIState::think(BattleAction *action)
 				{
 					controlOrPanic = 0;
 				}
-				if (RNG::generate(0, 100) >= controlOrPanic)
+				if (RNG::generate(RNG::AI, 0, 100) >= controlOrPanic)
 				{
 					action->type = BA_MINDCONTROL;
 					action->target = _aggroTarget->getPosition();
@@ -345,7 +345,7 @@ void AggroBAIState::think(BattleAction *action)
 			bool takeCover = true;
 			bool charge = false;
 			_unit->setCharging(0);
-			int number = RNG::generate(0,100);
+			int number = RNG::generate(RNG::AI, 0,100);
 
 			// extra 5% chance per unit that sees us
 			number += unitsSpottingMe * 5;
@@ -457,7 +457,7 @@ void AggroBAIState::think(BattleAction *action)
 						if(((_unit->getFaction() == FACTION_NEUTRAL && _aggroTarget->getFaction() == FACTION_HOSTILE) || _unit->getFaction() == FACTION_HOSTILE))
 						{
 							if (action->weapon->getAmmoItem()->getRules()->getDamageType() != DT_HE || explosiveEfficacy(_aggroTarget->getPosition(), _unit, (action->weapon->getAmmoItem()->getRules()->getPower() / 10) +1, action->diff))
-							if (RNG::generate(1,10) < 5 && action->weapon->getAmmoQuantity() > 2)
+							if (RNG::generate(RNG::AI, 1,10) < 5 && action->weapon->getAmmoQuantity() > 2)
 								action->type = BA_AUTOSHOT;
 							else
 								action->type = BA_SNAPSHOT;
@@ -486,8 +486,8 @@ void AggroBAIState::think(BattleAction *action)
 				{
 					tries++;
 					action->target = _unit->getPosition();
-					action->target.x += RNG::generate(-5,5);
-					action->target.y += RNG::generate(-5,5);
+					action->target.x += RNG::generate(RNG::AI, -5,5);
+					action->target.y += RNG::generate(RNG::AI, -5,5);
 					if (tries < 20)
 
 						coverFound = !_game->getTileEngine()->visible(_aggroTarget, _game->getTile(action->target));
@@ -571,7 +571,7 @@ bool AggroBAIState::explosiveEfficacy(Position targetPos, BattleUnit *attackingU
 		}
 	}
 	// spice things up a bit by adding a random number based on difficulty level
-	efficacy += RNG::generate(0, diff+1) - RNG::generate(0,2);
+	efficacy += RNG::generate(RNG::AI, 0, diff+1) - RNG::generate(RNG::AI, 0,2);
 	if (efficacy > 0 || enemiesAffected >= 10)
 		return true;
 	return false;
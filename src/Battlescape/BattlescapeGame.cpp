@@ -458,7 +458,7 @@ void BattlescapeGame::checkForCasualties(BattleItem *murderweapon, BattleUnit *m
 					{
 						int closest = 1000000;
 						BattleUnit *revenger = 0;
-						bool revenge = RNG::generate(0,100) < 50;
+						bool revenge = RNG::generate(RNG::BATTLESCAPE, 0,100) < 50;
 						for (std::vector<BattleUnit*>::iterator h = _save->getUnits()->begin(); h != _save->getUnits()->end(); ++h)
 						{
 							if ((*h)->getFaction() == FACTION_HOSTILE && !(*h)->isOut() && (*h) != victim)
@@ -966,7 +966,7 @@ bool BattlescapeGame::handlePanickingUnit(BattleUnit *unit)
 
 	unit->abortTurn(); //makes the unit go to status STANDING :p
 
-	int flee = RNG::generate(0,100);
+	int flee = RNG::generate(RNG::BATTLESCAPE, 0,100);
 	BattleAction ba;
 	switch (status)
 	{
@@ -986,7 +986,7 @@ bool BattlescapeGame::handlePanickingUnit(BattleUnit *unit)
 			unit->setCache(0);
 			BattleAction ba;
 			ba.actor = unit;
-			ba.target = Position(unit->getPosition().x + RNG::generate(-5,5), unit->getPosition().y + RNG::generate(-5,5), unit->getPosition().z);
+			ba.target = Position(unit->getPosition().x + RNG::generate(RNG::BATTLESCAPE, -5,5), unit->getPosition().y + RNG::generate(RNG::BATTLESCAPE, -5,5), unit->getPosition().z);
 			if (_save->getTile(ba.target)) // only walk towards it when the place exists
 			{
 				_save->getPathfinding()->calculate(ba.actor, ba.target);
@@ -998,7 +998,7 @@ bool BattlescapeGame::handlePanickingUnit(BattleUnit *unit)
 		for (int i= 0; i < 4; i++)
 		{
 			ba.actor = unit;
-			ba.target = Position(unit->getPosition().x + RNG::generate(-5,5), unit->getPosition().y + RNG::generate(-5,5), unit->getPosition().z);
+			ba.target = Position(unit->getPosition().x + RNG::generate(RNG::BATTLESCAPE, -5,5), unit->getPosition().y + RNG::generate(RNG::BATTLESCAPE, -5,5), unit->getPosition().z);
 			statePushBack(new UnitTurnBState(this, ba));
 		}
 		for (std::vector<BattleUnit*>::iterator j = unit->getVisibleUnits()->begin(); j != unit->getVisibleUnits()->end(); ++j)
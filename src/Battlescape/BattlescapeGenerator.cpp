@@ -192,6 +192,7 @@ void BattlescapeGenerator::nextStage()
 	}
 
 	_save->initMap(_width, _length, _height);
+	_save->initUtilities(_res);
 	generateMap();
 
 	for (std::vector<BattleUnit*>::iterator j = _save->getUnits()->begin(); j != _save->getUnits()->end(); ++j)
@@ -345,7 +346,7 @@ void BattlescapeGenerator::run()
 		for (std::vector<Soldier*>::iterator i = _base->getSoldiers()->begin(); i != _base->getSoldiers()->end(); ++i)
 		{
 			if ((*i)->getCraft() == _craft ||
-				(_craft == 0 && (*i)->getWoundRecovery() == 0 && ((*i)->getCraft() == 0 || (*i)->getCraft()->getStatus() != "STR_OUT")))
+				(_craft == 0 && (*i)->getWoundRecovery() == 0 && ((*i)->getCraft() == 0 || (*i)->getCraft()->getStatus() != CRAFT_OUT)))
 			{
 				unit = addXCOMUnit(new BattleUnit(*i, FACTION_PLAYER));
 				if (!_save->getSelectedUnit())
@@ -367,7 +368,7 @@ void BattlescapeGenerator::run()
 		if (_craft != 0)
 		{
 			// add items that are in the craft
-			for (std::map<std::string, int>::iterator i = _craft->getItems()->getContents()->begin(); i != _craft->getItems()->getContents()->end(); ++i)
+			for (std::map<std::string, int>::const_iterator i = _craft->getItems()->getContents()->begin(); i != _craft->getItems()->getContents()->end(); ++i)
 			{
 				for (int count=0; count < i->second; count++)
 				{
@@ -379,7 +380,7 @@ void BattlescapeGenerator::run()
 		else
 		{
 			// add items that are in the base
-			for (std::map<std::string, int>::iterator i = _base->getItems()->getContents()->begin(); i != _base->getItems()->getContents()->end(); ++i)
+			for (std::map<std::string, int>::const_iterator i = _base->getItems()->getContents()->begin(); i != _base->getItems()->getContents()->end(); ++i)
 			{
 				// only put items in the battlescape that make sense (when the item got a sprite, it's probably ok)
 				RuleItem *rule = _game->getRuleset()->getItem(i->first);
@@ -395,9 +396,9 @@ void BattlescapeGenerator::run()
 			// add items from crafts in base
 			for (std::vector<Craft*>::iterator c = _base->getCrafts()->begin(); c != _base->getCrafts()->end(); ++c)
 			{
-				if ((*c)->getStatus() == "STR_OUT")
+				if ((*c)->getStatus() == CRAFT_OUT)
 					continue;
-				for (std::map<std::string, int>::iterator i = (*c)->getItems()->getContents()->begin(); i != (*c)->getItems()->getContents()->end(); ++i)
+				for (std::map<std::string, int>::const_iterator i = (*c)->getItems()->getContents()->begin(); i != (*c)->getItems()->getContents()->end(); ++i)
 				{
 					for (int count=0; count < i->second; count++)
 					{
@@ -510,7 +511,7 @@ BattleUnit *BattlescapeGenerator::addXCOMUnit(BattleUnit *unit)
 			_save->setUnitPosition(unit, node->getPosition());
 		}
 		_craftInventoryTile = _save->getTile(node->getPosition());
-		unit->setDirection(RNG::generate(0,7));
+		unit->setDirection(RNG::generate(RNG::BATTLESCAPE, 0,7));
 	}
 	else
 	{
@@ -553,15 +554,15 @@ void BattlescapeGenerator::deployAliens(AlienRace *race, AlienDeployment *deploy
 	{
 		std::string alienName = race->getMember((*d).alienRank);
 
-		int quantity = (*d).lowQty + RNG::generate(0, (*d).dQty); // beginner/experienced
+		int quantity = (*d).lowQty + RNG::generate(RNG::BATTLESCAPE, 0, (*d).dQty); // beginner/experienced
 		if( _game->getSavedGame()->getDifficulty() > DIFF_EXPERIENCED )
-			quantity = (*d).lowQty+(((*d).highQty-(*d).lowQty)/2) + RNG::generate(0, (*d).dQty); // veteran/genius
+			quantity = (*d).lowQty+(((*d).highQty-(*d).lowQty)/2) + RNG::generate(RNG::BATTLESCAPE, 0, (*d).dQty); // veteran/genius
 		else if( _game->getSavedGame()->getDifficulty() > DIFF_GENIUS )
-			quantity = (*d).highQty + RNG::generate(0, (*d).dQty); // super
+			quantity = (*d).highQty + RNG::generate(RNG::BATTLESCAPE, 0, (*d).dQty); // super
 
 		for (int i = 0; i < quantity; i++)
 		{
-			bool outside = RNG::generate(0,99) < (*d).percentageOutsideUfo;
+			bool outside = RNG::generate(RNG::BATTLESCAPE, 0,99) < (*d).percentageOutsideUfo;
 			if (_ufo == 0)
 				outside = false;
 			BattleUnit *unit = addAlien(_game->getRuleset()->getUnit(alienName), (*d).alienRank, outside);
@@ -636,7 +637,7 @@ BattleUnit *BattlescapeGenerator::addAlien(Unit *rules, int alienRank, bool outs
 		if (dir != -1)
 			unit->setDirection(dir);
 		else
-			unit->setDirection(RNG::generate(0,7));
+			unit->setDirection(RNG::generate(RNG::BATTLESCAPE, 0,7));
 
 		UnitStats *stats = unit->getStats();
 
@@ -676,7 +677,7 @@ BattleUnit *BattlescapeGenerator::addCivilian(Unit *rules)
 	{
 		_save->setUnitPosition(unit, node->getPosition());
 		unit->setAIState(new PatrolBAIState(_game->getSavedGame()->getBattleGame(), unit, node));
-		unit->setDirection(RNG::generate(0,7));
+		unit->setDirection(RNG::generate(RNG::BATTLESCAPE, 0,7));
 	}
 
 	_save->getUnits()->push_back(unit);
@@ -950,8 +951,8 @@ void BattlescapeGenerator::generateMap()
 		// pick a random ufo mapblock, can have all kinds of sizes
 		ufoMap = _ufo->getRules()->getBattlescapeTerrainData()->getRandomMapBlock(999, MT_DEFAULT);
 
-		ufoX = RNG::generate(0, (_length / 10) - ufoMap->getWidth() / 10);
-		ufoY = RNG::generate(0, (_width / 10) - ufoMap->getLength() / 10);
+		ufoX = RNG::generate(RNG::BATTLESCAPE, 0, (_length / 10) - ufoMap->getWidth() / 10);
+		ufoY = RNG::generate(RNG::BATTLESCAPE, 0, (_width / 10) - ufoMap->getLength() / 10);
 
 		for (int i = 0; i < ufoMap->getWidth() / 10; ++i)
 		{
@@ -970,8 +971,8 @@ void BattlescapeGenerator::generateMap()
 		craftMap = _craft->getRules()->getBattlescapeTerrainData()->getRandomMapBlock(999, MT_DEFAULT);
 		while (!placed)
 		{
-			craftX = RNG::generate(0, (_length/10)- craftMap->getWidth() / 10);
-			craftY = RNG::generate(0, (_width/10)- craftMap->getLength() / 10);
+			craftX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- craftMap->getWidth() / 10);
+			craftY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- craftMap->getLength() / 10);
 			placed = true;
 			// check if this place is ok
 			for (int i = 0; i < craftMap->getWidth() / 10; ++i)
@@ -997,16 +998,16 @@ void BattlescapeGenerator::generateMap()
 	/* determine positioning of the urban terrain roads */
 	if (_save->getMissionType() == "STR_TERROR_MISSION")
 	{
-		bool EWRoad = RNG::generate(0,99) < 33;
+		bool EWRoad = RNG::generate(RNG::BATTLESCAPE, 0,99) < 33;
 		bool NSRoad = !EWRoad;
-		bool TwoRoads = RNG::generate(0,99) < 25;
+		bool TwoRoads = RNG::generate(RNG::BATTLESCAPE, 0,99) < 25;
 		int roadX = craftX;
 		int roadY = craftY;
 		// make sure the road(s) are not crossing the craftin landing site
 		while (roadX == craftX || roadY == craftY)
 		{
-			roadX = RNG::generate(0, (_length/10)- 1);
-			roadY = RNG::generate(0, (_width/10)- 1);
+			roadX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- 1);
+			roadY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- 1);
 		}
 		if (TwoRoads)
 		{
@@ -1085,8 +1086,8 @@ void BattlescapeGenerator::generateMap()
 	/* determine positioning of base modules */
 	else if (_save->getMissionType() == "STR_ALIEN_BASE_ASSAULT" || _save->getMissionType() == "STR_MARS_THE_FINAL_ASSAULT")
 	{
-		int randX = RNG::generate(0, (_length/10)- 2);
-		int randY = RNG::generate(0, (_width/10)- 2);
+		int randX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- 2);
+		int randY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- 2);
 		// add the command center
 		blocks[randX][randY] = _terrain->getRandomMapBlock(20, (_save->getMissionType() == "STR_MARS_THE_FINAL_ASSAULT")?MT_FINALCOMM:MT_UBASECOMM);
 		blocksToDo--;
@@ -1102,8 +1103,8 @@ void BattlescapeGenerator::generateMap()
 		{
 			while (blocks[randX][randY] != NULL)
 			{
-				randX = RNG::generate(0, (_length/10)- 1);
-				randY = RNG::generate(0, (_width/10)- 1);
+				randX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- 1);
+				randY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- 1);
 			}
 			// add the lift
 			blocks[randX][randY] = _terrain->getRandomMapBlock(10, MT_XCOMSPAWN);
@@ -1112,13 +1113,13 @@ void BattlescapeGenerator::generateMap()
 	}
 	else if (_save->getMissionType() == "STR_MARS_CYDONIA_LANDING")
 	{
-		int randX = RNG::generate(0, (_length/10)- 2);
-		int randY = RNG::generate(0, (_width/10)- 2);
+		int randX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- 2);
+		int randY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- 2);
 		// add one lift
 		while (blocks[randX][randY] != NULL || landingzone[randX][randY])
 		{
-			randX = RNG::generate(0, (_length/10)- 1);
-			randY = RNG::generate(0, (_width/10)- 1);
+			randX = RNG::generate(RNG::BATTLESCAPE, 0, (_length/10)- 1);
+			randY = RNG::generate(RNG::BATTLESCAPE, 0, (_width/10)- 1);
 		}
 		// add the lift
 		blocks[randX][randY] = _terrain->getRandomMapBlock(10, MT_XCOMSPAWN);
@@ -1566,13 +1567,13 @@ void BattlescapeGenerator::explodePowerSources()
 	for (int i = 0; i < _save->getWidth() * _save->getLength() * _save->getHeight(); ++i)
 	{
 		if (_save->getTiles()[i]->getMapData(MapData::O_OBJECT) 
-			&& _save->getTiles()[i]->getMapData(MapData::O_OBJECT)->getSpecialType() == UFO_POWER_SOURCE && RNG::generate(0,100) < 75)
+			&& _save->getTiles()[i]->getMapData(MapData::O_OBJECT)->getSpecialType() == UFO_POWER_SOURCE && RNG::generate(RNG::BATTLESCAPE, 0,100) < 75)
 		{
 			Position pos;
 			pos.x = _save->getTiles()[i]->getPosition().x*16;
 			pos.y = _save->getTiles()[i]->getPosition().y*16;
 			pos.z = (_save->getTiles()[i]->getPosition().z*24) +12;
-			_save->getTileEngine()->explode(pos, 180+RNG::generate(0,70), DT_HE, 11);
+			_save->getTileEngine()->explode(pos, 180+RNG::generate(RNG::BATTLESCAPE, 0,70), DT_HE, 11);
 		}
 	}
 }
@@ -1584,11 +1585,11 @@ void BattlescapeGenerator::deployCivilians(int max)
 {
 	if (max)
 	{
-		int number = RNG::generate(1, max);
+		int number = RNG::generate(RNG::BATTLESCAPE, 1, max);
 
 		for (int i = 0; i < number; ++i)
 		{
-			if (RNG::generate(0,100) < 50)
+			if (RNG::generate(RNG::BATTLESCAPE, 0,100) < 50)
 			{
 				addCivilian(_game->getRuleset()->getUnit("MALE_CIVILIAN"));
 			}
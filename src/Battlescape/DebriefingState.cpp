@@ -593,6 +593,7 @@ void DebriefingState::prepareDebriefing()
 		addStat("STR_XCOM_CRAFT_LOST", 1, -craft->getRules()->getScore());
 		delete craft;
 		base->getCrafts()->erase(craftIterator);
+		base->craftsChanged();
 		for (std::vector<Soldier*>::iterator i = base->getSoldiers()->begin(); i != base->getSoldiers()->end();)
 		{
 			if ((*i)->getCraft() == craft)
@@ -730,7 +731,7 @@ void DebriefingState::prepareDebriefing()
 	{
 		for (std::vector<Craft*>::iterator c = base->getCrafts()->begin(); c != base->getCrafts()->end(); ++c)
 		{
-			if ((*c)->getStatus() != "STR_OUT")
+			if ((*c)->getStatus() != CRAFT_OUT)
 				reequipCraft(base, *c);
 		}
 	}
@@ -96,11 +96,11 @@ void ExplosionBState::init()
 	{
 		for (int i = 0; i < _power/5; i++)
 		{
-			int X = RNG::generate(-_power/2,_power/2);
-			int Y = RNG::generate(-_power/2,_power/2);
+			int X = RNG::generate(RNG::BATTLESCAPE, -_power/2,_power/2);
+			int Y = RNG::generate(RNG::BATTLESCAPE, -_power/2,_power/2);
 			Position p = _center;
 			p.x += X; p.y += Y;
-			Explosion *explosion = new Explosion(p, RNG::generate(0,6), true);
+			Explosion *explosion = new Explosion(p, RNG::generate(RNG::BATTLESCAPE, 0,6), true);
 			// add the explosion on the map
 			_parent->getMap()->getExplosions()->insert(explosion);
 		}
@@ -17,9 +17,15 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <list>
+#include <map>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <math.h>
 #include "Pathfinding.h"
 #include "PathfindingNode.h"
 #include "PathfindingOpenSet.h"
+#include "PathfindingGraph.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Ruleset/MapData.h"
@@ -31,12 +37,24 @@
 namespace OpenXcom
 {
 
+/**
+ * A portal of the PathfindingGraph as seen by one hierarchical search.
+ */
+struct HierarchicalNode
+{
+	int cost, prev, direction, block, portal;
+	bool checked;
+	HierarchicalNode() : cost(-1), prev(-1), direction(-1), block(-1), portal(-1), checked(false) {}
+};
+
 /**
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _nodes(), _unit(0), _pathPreviewed(false)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _nodes(), _openSet(), _generation(0), _movementType(MT_WALK), _unit(0), _pathPreviewed(false), _ignoreUnits(false)
 {
+	for (int i = 0; i < 3; ++i)
+		_graphs[i] = 0;
 	_size = _save->getHeight() * _save->getLength() * _save->getWidth();
 	// Initialize one node per tile
 	_nodes.reserve(_size);
@@ -46,26 +64,47 @@ Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _nodes(), _unit(0
 		_save->getTileCoords(i, &p.x, &p.y, &p.z);
 		_nodes.push_back(PathfindingNode(p));
 	}
+	_tuCostChanges = _save->getTerrainChangeCount();
 	_strafeMove = false;
 }
 
 /**
  * Deletes the Pathfinding.
- * @internal This is required to be here because it requires the PathfindingNode class definition.
+ * @internal This is required to be here because it requires the PathfindingNode and PathfindingGraph class definitions.
  */
 Pathfinding::~Pathfinding()
 {
-	// Nothing more to do here.
+	for (int i = 0; i < 3; ++i)
+		delete _graphs[i];
 }
 
 /**
  * Gets the Node on a given position on the map.
+ * The node is reset first if the current search hasn't touched it yet.
  * @param pos position
  * @return Pointer to node.
  */
 PathfindingNode *Pathfinding::getNode(const Position& pos)
 {
-	return &_nodes[_save->getTileIndex(pos)];
+	PathfindingNode *node = &_nodes[_save->getTileIndex(pos)];
+	node->refresh(_generation);
+	return node;
+}
+
+/**
+ * Starts a new search. Instead of resetting every node on the map,
+ * the search counter is advanced and nodes are reset as they are reached.
+ */
+void Pathfinding::startSearch()
+{
+	_openSet.clear();
+	if (++_generation == 0)
+	{
+		// the counter wrapped around, so old stamps could look current again
+		for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+			it->reset(0);
+		_generation = 1;
+	}
 }
 
 /**
@@ -81,11 +120,12 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	if (missileTarget != 0)
 		_movementType = MT_FLY;
 	_unit = unit;
+	updateTUCostCache();
 
 	Tile *destinationTile = _save->getTile(endPosition);
 
 	// check if destination is not blocked
-	if (isBlocked(destinationTile, MapData::O_FLOOR, missileTarget) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget)) return;
+	if (isBlocked(destinationTile, MapData::O_FLOOR, missileTarget, _unit) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget)) return;
 
 	// the following check avoids that the unit walks behind the stairs if we click behind the stairs to make it go up the stairs.
 	// it only works if the unit is on one of the 2 tiles on the stairs, or on the tile right in front of the stairs.
@@ -96,7 +136,7 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	}
 
 	// check if we have floor, else lower destination (for non flying units only, because otherwise they never reached this place)
-	while (canFallDown(destinationTile, _unit->getArmor()->getSize()) && _movementType != MT_FLY)
+	while (canFallDown(destinationTile, _unit->getArmor()->getSize(), _unit) && _movementType != MT_FLY)
 	{
 		endPosition.z--;
 		destinationTile = _save->getTile(endPosition);
@@ -116,6 +156,11 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	}
 	_path.clear(); // if bresenham failed, we shouldn't keep the path it was attempting, in case A* fails too.
 	
+	// long walks of the AI are planned over the map blocks first, falling back to A* if that fails.
+	// only the part beyond this turn's TUs can be longer than the shortest path, so the player's units always use A*.
+	if (missileTarget == 0 && _unit->getFaction() != FACTION_PLAYER && _unit->getArmor()->getSize() == 1 && hierarchicalPath(startPosition, endPosition))
+		return;
+
 	// Now try through A*.
 	aStarPath(startPosition, endPosition, missileTarget);
 }
@@ -130,14 +175,12 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
  */
 bool Pathfinding::aStarPath(const Position &startPosition, const Position &endPosition, BattleUnit *missileTarget)
 {
-	// reset every node, so we have to check them all
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-		it->reset();
+	startSearch();
 
 	// start position is the first one in our "open" list
 	PathfindingNode *start = getNode(startPosition);
 	start->connect(0, 0, 0, endPosition);
-	PathfindingOpenSet openList;
+	PathfindingOpenSet &openList = _openSet;
 	openList.push(start);
 
 	// if the open list is empty, we've reached the end
@@ -162,7 +205,7 @@ bool Pathfinding::aStarPath(const Position &startPosition, const Position &endPo
 		for (int direction = 0; direction < 10; direction++)
 		{
 			Position nextPos;
-			int tuCost = getTUCost(currentPos, direction, &nextPos, _unit, missileTarget);
+			int tuCost = getCachedTUCost(currentPos, direction, &nextPos, _unit, missileTarget);
 			if (tuCost == 255) // Skip unreachable / blocked
 				continue;
 			PathfindingNode *nextNode = getNode(nextPos);
@@ -181,6 +224,382 @@ bool Pathfinding::aStarPath(const Position &startPosition, const Position &endPo
 	return false;
 }
 
+/**
+ * Calculate a path between two distant positions using the PathfindingGraph.
+ * Only the blocks of the start and end positions are searched tile by tile,
+ * the blocks in between reuse the paths stored in the graph. The result is
+ * checked step by step, since the graph does not know about units.
+ * The graph only keeps one crossing per open stretch of a block side, so the path
+ * found is not always the shortest one. The part the unit can walk with its
+ * TUs left is searched again with A*, so only the rest of the way can be longer.
+ * @param startPosition The position to start from.
+ * @param endPosition The position we want to reach.
+ * @return True if a path was found, false if the positions are too close or the search failed.
+ */
+bool Pathfinding::hierarchicalPath(const Position &startPosition, const Position &endPosition)
+{
+	PathfindingGraph *&graph = _graphs[_movementType];
+	if (!graph)
+		graph = new PathfindingGraph(_save, this);
+	int startBlock = graph->getBlock(startPosition);
+	int endBlock = graph->getBlock(endPosition);
+	if (graph->areNeighbours(startBlock, endBlock))
+		return false;
+	graph->update(_unit);
+
+	const int goal = -1;
+	std::map<int, HierarchicalNode> nodes;
+	std::map<int, std::vector<int> > startPaths, endPaths;
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > openList;
+	int minX, minY, maxX, maxY;
+
+	// walk to every portal of the first block
+	graph->getBlockArea(startBlock, &minX, &minY, &maxX, &maxY);
+	searchArea(startPosition, minX, minY, maxX, maxY, 0, _unit);
+	const std::vector<int> &startPortals = graph->getPortals(startBlock);
+	for (size_t i = 0; i != startPortals.size(); ++i)
+	{
+		Position pos;
+		_save->getTileCoords(startPortals[i], &pos.x, &pos.y, &pos.z);
+		int cost;
+		std::vector<int> path;
+		if (!getSearchResult(pos, &cost, &path))
+			continue;
+		startPaths[startPortals[i]].swap(path);
+		HierarchicalNode &node = nodes[startPortals[i]];
+		node.cost = cost;
+		node.block = startBlock;
+		node.portal = i;
+		Position d = endPosition - pos;
+		d *= d;
+		openList.push(std::make_pair(cost + (int)(4 * sqrt((double)d.x + d.y + d.z)), startPortals[i]));
+	}
+
+	while (!openList.empty())
+	{
+		int key = openList.top().second;
+		openList.pop();
+		HierarchicalNode &current = nodes[key];
+		if (current.checked)
+			continue;
+		current.checked = true;
+		if (key == goal)
+			break;
+
+		std::vector<std::pair<int, HierarchicalNode> > next;
+		if (current.block == endBlock)
+		{
+			// walk from this portal of the last block to the target
+			Position pos;
+			_save->getTileCoords(key, &pos.x, &pos.y, &pos.z);
+			graph->getBlockArea(endBlock, &minX, &minY, &maxX, &maxY);
+			searchArea(pos, minX, minY, maxX, maxY, &endPosition, _unit);
+			int cost;
+			std::vector<int> path;
+			if (getSearchResult(endPosition, &cost, &path))
+			{
+				endPaths[key].swap(path);
+				HierarchicalNode node;
+				node.cost = current.cost + cost;
+				next.push_back(std::make_pair(goal, node));
+			}
+		}
+		const std::vector<int> &portals = graph->getPortals(current.block);
+		for (size_t i = 0; i != portals.size(); ++i)
+		{
+			if ((int)i == current.portal)
+				continue;
+			int cost = graph->getPortalCost(current.block, current.portal, i, _unit);
+			if (cost == -1)
+				continue;
+			HierarchicalNode node;
+			node.cost = current.cost + cost;
+			node.block = current.block;
+			node.portal = i;
+			next.push_back(std::make_pair(portals[i], node));
+		}
+		const std::vector<PathfindingGraph::Crossing> &exits = graph->getExits(current.block);
+		for (std::vector<PathfindingGraph::Crossing>::const_iterator i = exits.begin(); i != exits.end(); ++i)
+		{
+			if (i->from != key)
+				continue;
+			Position pos;
+			_save->getTileCoords(i->to, &pos.x, &pos.y, &pos.z);
+			HierarchicalNode node;
+			node.cost = current.cost + i->cost;
+			node.direction = i->direction;
+			node.block = graph->getBlock(pos);
+			const std::vector<int> &entries = graph->getPortals(node.block);
+			std::vector<int>::const_iterator entry = std::lower_bound(entries.begin(), entries.end(), i->to);
+			if (entry == entries.end() || *entry != i->to)
+				continue;
+			node.portal = entry - entries.begin();
+			next.push_back(std::make_pair(i->to, node));
+		}
+
+		for (std::vector<std::pair<int, HierarchicalNode> >::iterator i = next.begin(); i != next.end(); ++i)
+		{
+			HierarchicalNode &node = nodes[i->first];
+			if (node.checked || (node.cost != -1 && node.cost <= i->second.cost))
+				continue;
+			node = i->second;
+			node.prev = key;
+			int guess = 0;
+			if (i->first != goal)
+			{
+				Position d;
+				_save->getTileCoords(i->first, &d.x, &d.y, &d.z);
+				d = endPosition - d;
+				d *= d;
+				guess = 4 * sqrt((double)d.x + d.y + d.z);
+			}
+			openList.push(std::make_pair(node.cost + guess, i->first));
+		}
+	}
+	if (!nodes[goal].checked)
+		return false;
+
+	// put the pieces of the path together
+	std::vector<int> chain;
+	for (int key = nodes[goal].prev; key != -1; key = nodes[key].prev)
+		chain.push_back(key);
+	std::reverse(chain.begin(), chain.end());
+	std::vector<int> steps = startPaths[chain.front()];
+	for (size_t i = 1; i < chain.size(); ++i)
+	{
+		const HierarchicalNode &node = nodes[chain[i]];
+		if (node.direction != -1)
+		{
+			steps.push_back(node.direction);
+		}
+		else
+		{
+			const std::vector<int> &path = graph->getPortalPath(node.block, nodes[chain[i - 1]].portal, node.portal);
+			steps.insert(steps.end(), path.begin(), path.end());
+		}
+	}
+	steps.insert(steps.end(), endPaths[chain.back()].begin(), endPaths[chain.back()].end());
+
+	// make sure no unit is standing in the way of the stored paths,
+	// and find how far along them the unit gets with the TUs it has left
+	Position pos = startPosition, waypoint = startPosition;
+	int tuCost = 0;
+	size_t reached = 0;
+	for (size_t i = 0; i != steps.size(); ++i)
+	{
+		Position nextPos;
+		int cost = getTUCost(pos, steps[i], &nextPos, _unit, 0);
+		if (cost == 255)
+			return false;
+		tuCost += cost;
+		pos = nextPos;
+		if (tuCost <= _unit->getTimeUnits())
+		{
+			waypoint = pos;
+			reached = i + 1;
+		}
+	}
+	if (pos != endPosition)
+		return false;
+
+	// the part walked this turn is replaced by the shortest path to the same place,
+	// so the unit never spends more TUs on it than A* would
+	if (reached != 0 && aStarPath(startPosition, waypoint, 0))
+	{
+		_path.insert(_path.begin(), steps.rbegin(), steps.rbegin() + (steps.size() - reached));
+		return true;
+	}
+	_path.assign(steps.rbegin(), steps.rend());
+	return true;
+}
+
+/**
+ * Search the tiles reachable from a position without leaving an area, on any level.
+ * With a target this is an A* search that stops on the target, otherwise every
+ * reachable tile of the area is visited. The results are read with getSearchResult.
+ * @param startPosition The position to start from.
+ * @param minX Lowest X coordinate of the area.
+ * @param minY Lowest Y coordinate of the area.
+ * @param maxX Highest X coordinate of the area.
+ * @param maxY Highest Y coordinate of the area.
+ * @param target Pointer to the position we want to reach, or 0 to visit the whole area.
+ * @param unit The unit that moves.
+ */
+void Pathfinding::searchArea(const Position &startPosition, int minX, int minY, int maxX, int maxY, const Position *target, BattleUnit *unit)
+{
+	startSearch();
+	PathfindingNode *start = getNode(startPosition);
+	if (target)
+		start->connect(0, 0, 0, *target);
+	else
+		start->connect(0, 0, 0);
+	_openSet.push(start);
+
+	while (!_openSet.empty())
+	{
+		PathfindingNode *currentNode = _openSet.pop();
+		Position const &currentPos = currentNode->getPosition();
+		currentNode->setChecked();
+		if (target && currentPos == *target)
+			return;
+
+		for (int direction = 0; direction < 10; direction++)
+		{
+			Position nextPos;
+			int tuCost = getCachedTUCost(currentPos, direction, &nextPos, unit, 0);
+			if (tuCost == 255)
+				continue;
+			if (nextPos.x < minX || nextPos.x > maxX || nextPos.y < minY || nextPos.y > maxY)
+				continue;
+			PathfindingNode *nextNode = getNode(nextPos);
+			if (nextNode->isChecked())
+				continue;
+			int totalTuCost = currentNode->getTUCost(false) + tuCost;
+			if (!nextNode->inOpenSet() || nextNode->getTUCost(false) > totalTuCost)
+			{
+				if (target)
+					nextNode->connect(totalTuCost, currentNode, direction, *target);
+				else
+					nextNode->connect(totalTuCost, currentNode, direction);
+				_openSet.push(nextNode);
+			}
+		}
+	}
+}
+
+/**
+ * Get the cost and path to a position found by the last searchArea.
+ * @param pos The position to look up.
+ * @param cost Pointer to the TU cost to reach it.
+ * @param path Pointer to the directions to walk, in order.
+ * @return True if the search reached the position.
+ */
+bool Pathfinding::getSearchResult(const Position &pos, int *cost, std::vector<int> *path)
+{
+	PathfindingNode *node = &_nodes[_save->getTileIndex(pos)];
+	if (!node->isCurrent(_generation) || !node->isChecked())
+		return false;
+	*cost = node->getTUCost(false);
+	path->clear();
+	for (PathfindingNode *pf = node; pf->getPrevNode(); pf = pf->getPrevNode())
+	{
+		path->push_back(pf->getPrevDir());
+	}
+	std::reverse(path->begin(), path->end());
+	return true;
+}
+
+/**
+ * Drop the cached TU costs of every step that could be affected by
+ * a tile whose terrain changed since the last call, going by the battle's log of terrain changes.
+ */
+void Pathfinding::updateTUCostCache()
+{
+	std::vector<Position> changes;
+	if (!_save->getTerrainChanges(&_tuCostChanges, &changes))
+	{
+		// too much changed to keep track of, the caches are filled again as needed
+		for (int type = 0; type < 3; ++type)
+		{
+			for (int size = 0; size < 2; ++size)
+			{
+				_tuCostCache[type][size].clear();
+			}
+		}
+		return;
+	}
+	for (std::vector<Position>::const_iterator i = changes.begin(); i != changes.end(); ++i)
+	{
+		// steps of large units check up to two tiles away, stairs and falls one level up or down
+		const Position &changed = *i;
+		for (int z = std::max(0, changed.z - 1); z <= std::min(_save->getHeight() - 1, changed.z + 1); ++z)
+		{
+			for (int y = std::max(0, changed.y - 2); y <= std::min(_save->getLength() - 1, changed.y + 2); ++y)
+			{
+				for (int x = std::max(0, changed.x - 2); x <= std::min(_save->getWidth() - 1, changed.x + 2); ++x)
+				{
+					int index = _save->getTileIndex(Position(x, y, z)) * 10;
+					for (int type = 0; type < 3; ++type)
+					{
+						for (int size = 0; size < 2; ++size)
+						{
+							if (!_tuCostCache[type][size].empty())
+								std::fill(_tuCostCache[type][size].begin() + index, _tuCostCache[type][size].begin() + index + 10, -1);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Check if a unit other than the given one stands on any level of the
+ * columns covered by a unit at a position. Those are the only tiles where
+ * units change the outcome of getTUCost.
+ * @param pos Position of the unit.
+ * @param size Size of the unit.
+ * @param unit The unit itself.
+ * @return True if another unit was found.
+ */
+bool Pathfinding::hasUnitsInColumns(const Position &pos, int size, BattleUnit *unit) const
+{
+	for (int x = pos.x; x < pos.x + size; ++x)
+	{
+		for (int y = pos.y; y < pos.y + size; ++y)
+		{
+			if (x < 0 || y < 0 || x >= _save->getWidth() || y >= _save->getLength())
+				continue;
+			for (int z = 0; z < _save->getHeight(); ++z)
+			{
+				BattleUnit *bu = _save->getTile(Position(x, y, z))->getUnit();
+				if (bu && bu != unit)
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Get's the TU cost to move from 1 tile to the other(ONE STEP ONLY), like getTUCost.
+ * The terrain part of the cost is remembered per movement type and unit size,
+ * and only recalculated when the terrain around the step changed or another
+ * unit stands where the step could end.
+ * @param startPosition
+ * @param direction
+ * @param endPosition pointer
+ * @param unit
+ * @param missileTarget
+ * @return TU cost - 255 if movement impossible
+ */
+int Pathfinding::getCachedTUCost(const Position &startPosition, int direction, Position *endPosition, BattleUnit *unit, BattleUnit *missileTarget)
+{
+	int size = unit->getArmor()->getSize();
+	if (missileTarget != 0 || _strafeMove || size > 2)
+		return getTUCost(startPosition, direction, endPosition, unit, missileTarget);
+	directionToVector(direction, endPosition);
+	*endPosition += startPosition;
+	if (!_ignoreUnits && hasUnitsInColumns(*endPosition, size, unit))
+		return getTUCost(startPosition, direction, endPosition, unit, missileTarget);
+
+	std::vector<int> &cache = _tuCostCache[_movementType][size - 1];
+	if (cache.empty())
+		cache.assign(_size * 10, -1);
+	int &entry = cache[_save->getTileIndex(startPosition) * 10 + direction];
+	if (entry == -1)
+	{
+		bool ignoreUnits = _ignoreUnits;
+		_ignoreUnits = true;
+		int cost = getTUCost(startPosition, direction, endPosition, unit, 0);
+		_ignoreUnits = ignoreUnits;
+		entry = cost | ((endPosition->z - startPosition.z + 2) << 8);
+		return cost;
+	}
+	endPosition->z = startPosition.z + (entry >> 8) - 2;
+	return entry & 0xFF;
+}
+
 /**
  * Get's the TU cost to move from 1 tile to the other(ONE STEP ONLY). But also updates the endPosition, because it is possible
  * the unit goes upstairs or falls down while walking.
@@ -192,12 +611,11 @@ bool Pathfinding::aStarPath(const Position &startPosition, const Position &endPo
  */
 int Pathfinding::getTUCost(const Position &startPosition, int direction, Position *endPosition, BattleUnit *unit, BattleUnit *missileTarget)
 {
-	_unit = unit;
 	directionToVector(direction, endPosition);
 	*endPosition += startPosition;
 	bool fellDown = false;
 	bool triedStairs = false;
-	int size = _unit->getArmor()->getSize() - 1;
+	int size = unit->getArmor()->getSize() - 1;
 	int cost = 0;
 	int numberOfPartsChangingLevel = 0;
 	int numberOfPartsChangingHeight = 0;
@@ -217,13 +635,14 @@ int Pathfinding::getTUCost(const Position &startPosition, int direction, Positio
 				return 255;
 
 			// check if the destination tile can be walked over
-			if (isBlocked(destinationTile, MapData::O_FLOOR, missileTarget) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget))
+			if (isBlocked(destinationTile, MapData::O_FLOOR, missileTarget, unit) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget))
 				return 255;
 
 			// can't walk on top of other units
-			if (_save->getTile(*endPosition + Position(x,y,-1))
+			if (!_ignoreUnits
+				&& _save->getTile(*endPosition + Position(x,y,-1))
 				&& _save->getTile(*endPosition + Position(x,y,-1))->getUnit()
-				&& _save->getTile(*endPosition + Position(x,y,-1))->getUnit() != _unit
+				&& _save->getTile(*endPosition + Position(x,y,-1))->getUnit() != unit
 				&& !_save->getTile(*endPosition + Position(x,y,-1))->getUnit()->isOut()
 				&& _movementType != MT_FLY && _save->getTile(*endPosition)->hasNoFloor())
 				return 255;
@@ -275,7 +694,7 @@ int Pathfinding::getTUCost(const Position &startPosition, int direction, Positio
 				wallcost += startTile->getTUCost(MapData::O_WESTWALL, _movementType);
 
 			// check if we have floor, else fall down
-			if (canFallDown(destinationTile) && (_movementType != MT_FLY || triedStairs))
+			if (canFallDown(destinationTile, unit) && (_movementType != MT_FLY || triedStairs))
 			{
 				numberOfPartsChangingLevel++;
 				if ((numberOfPartsChangingLevel == 4 && size == 1)||(numberOfPartsChangingLevel == 1 && size == 0) )
@@ -293,7 +712,7 @@ int Pathfinding::getTUCost(const Position &startPosition, int direction, Positio
 			}
 
 			// check if the destination tile can be walked over
-			if ((isBlocked(destinationTile, MapData::O_FLOOR, missileTarget) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget)) && !fellDown)
+			if ((isBlocked(destinationTile, MapData::O_FLOOR, missileTarget, unit) || isBlocked(destinationTile, MapData::O_OBJECT, missileTarget)) && !fellDown)
 			{
 				return 255;
 			}
@@ -325,13 +744,13 @@ int Pathfinding::getTUCost(const Position &startPosition, int direction, Positio
 				}
 				else
 				{
-					if (std::min(abs(8 + direction - _unit->getDirection()), std::min( abs(_unit->getDirection() - direction), abs(8 + _unit->getDirection() - direction))) > 2) {
+					if (std::min(abs(8 + direction - unit->getDirection()), std::min( abs(unit->getDirection() - direction), abs(8 + unit->getDirection() - direction))) > 2) {
 						// Strafing backwards-ish currently unsupported, turn it off and continue.
 						_strafeMove = false;
 					}
 					else
 					{
-						if (_unit->getDirection() != direction) {
+						if (unit->getDirection() != direction) {
 							cost += 1;
 						}
 					}
@@ -419,9 +838,10 @@ void Pathfinding::abortPath()
  * Whether a certain part of a tile blocks movement.
  * @param tile can be null pointer
  * @param movementType
+ * @param unit the unit that moves, which doesn't block itself. Only matters for the floor.
  * @return true/false
  */
-bool Pathfinding::isBlocked(Tile *tile, const int part, BattleUnit *missileTarget)
+bool Pathfinding::isBlocked(Tile *tile, const int part, BattleUnit *missileTarget, BattleUnit *unit)
 {
 	if (tile == 0) return true; // probably outside the map here
 
@@ -437,8 +857,8 @@ bool Pathfinding::isBlocked(Tile *tile, const int part, BattleUnit *missileTarge
 
 	if (part == MapData::O_FLOOR)
 	{
-		BattleUnit *unit = tile->getUnit();
-		if (unit != 0 && unit != _unit && unit != missileTarget) return true;
+		BattleUnit *tileUnit = tile->getUnit();
+		if (tileUnit != 0 && tileUnit != unit && tileUnit != missileTarget && !_ignoreUnits) return true;
 	}
 
 	if (tile->getTUCost(part, _movementType) == 255) return true; // blocking part
@@ -518,17 +938,18 @@ bool Pathfinding::isBlocked(Tile *startTile, Tile *endTile, const int direction,
  * We can fall down here, if the tile does not exist, the tile has no floor
  * the current position is higher than 0, if there is no unit standing below us
  * @param here
+ * @param unit the unit that falls
  * @return bool
  */
-bool Pathfinding::canFallDown(Tile *here)
+bool Pathfinding::canFallDown(Tile *here, BattleUnit *unit)
 {
 	if (here->getPosition().z == 0)
 		return false;
 
-	for (int z = 1; z <= here->getPosition().z; ++z)
+	for (int z = 1; z <= here->getPosition().z && !_ignoreUnits; ++z)
 	{
 		if (_save->selectUnit(here->getPosition() - Position(0, 0, z)) &&
-			_save->selectUnit(here->getPosition() - Position(0, 0, z)) != _unit &&
+			_save->selectUnit(here->getPosition() - Position(0, 0, z)) != unit &&
 			!_save->selectUnit(here->getPosition() - Position(0, 0, z))->isOut())
 			return false;
 	}
@@ -539,7 +960,7 @@ bool Pathfinding::canFallDown(Tile *here)
 		return false;
 }
 
-bool Pathfinding::canFallDown(Tile *here, int size)
+bool Pathfinding::canFallDown(Tile *here, int size, BattleUnit *unit)
 {
 	for (int x = 0; x != size; ++x)
 	{
@@ -547,7 +968,7 @@ bool Pathfinding::canFallDown(Tile *here, int size)
 		{
 			Position checkPos = here->getPosition() + Position(x,y,0);
 			Tile *checkTile = _save->getTile(checkPos);
-			if (!canFallDown(checkTile))
+			if (!canFallDown(checkTile, unit))
 				return false;
 		}
 	}
@@ -797,14 +1218,14 @@ bool Pathfinding::bresenhamPath(const Position& origin, const Position& target,
 std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
 {
 	const Position &start = unit->getPosition();
+	_movementType = unit->getArmor()->getMovementType();
+	_unit = unit;
+	updateTUCostCache();
 
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-	{
-		it->reset();
-	}
+	startSearch();
 	PathfindingNode *startNode = getNode(start);
 	startNode->connect(0, 0, 0);
-	PathfindingOpenSet unvisited;
+	PathfindingOpenSet &unvisited = _openSet;
 	unvisited.push(startNode);
 	std::vector<PathfindingNode*> reachable;
 	while (!unvisited.empty())
@@ -816,7 +1237,7 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
 		for (int direction = 0; direction < 10; direction++)
 		{
 			Position nextPos;
-			int tuCost = getTUCost(currentPos, direction, &nextPos, unit, 0);
+			int tuCost = getCachedTUCost(currentPos, direction, &nextPos, unit, 0);
 			if (tuCost == 255) // Skip unreachable / blocked
 				continue;
 			if (currentNode->getTUCost(false) + tuCost > tuMax) // Run out of TUs
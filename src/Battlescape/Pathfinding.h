@@ -21,6 +21,7 @@
 
 #include <vector>
 #include "Position.h"
+#include "PathfindingOpenSet.h"
 #include "../Ruleset/MapData.h"
 
 namespace OpenXcom
@@ -29,6 +30,7 @@ namespace OpenXcom
 class Position;
 class SavedBattleGame;
 class PathfindingNode;
+class PathfindingGraph;
 class Tile;
 class BattleUnit;
 
@@ -40,23 +42,45 @@ class Pathfinding
 private:
 	SavedBattleGame *_save;
 	std::vector<PathfindingNode> _nodes;
+	PathfindingOpenSet _openSet;
+	unsigned int _generation;
+	PathfindingGraph *_graphs[3];
+	/// TU cost and level change of every step, by movement type and unit size, -1 if unknown.
+	std::vector<int> _tuCostCache[3][2];
+	int _tuCostChanges;
 	int _size;
 	std::vector<int> _path;
 	MovementType _movementType;
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(const Position& pos);
+	/// Starts a new search over the nodes.
+	void startSearch();
 	/// whether a tile blocks a certain movementType
-	bool isBlocked(Tile *tile, const int part, BattleUnit *missileTarget);
-	bool canFallDown(Tile *destinationTile);
-	bool canFallDown(Tile *destinationTile, int size);
+	bool isBlocked(Tile *tile, const int part, BattleUnit *missileTarget, BattleUnit *unit = 0);
+	bool canFallDown(Tile *destinationTile, BattleUnit *unit);
+	bool canFallDown(Tile *destinationTile, int size, BattleUnit *unit);
 	bool isOnStairs(const Position &startPosition, const Position &endPosition);
 	BattleUnit *_unit;
 	bool _pathPreviewed;
 	bool _strafeMove;
+	bool _ignoreUnits;
 	///Try to find a straight line path between two positions.
 	bool bresenhamPath(const Position& origin, const Position& target, BattleUnit *missileTarget);
 	///Try to find a path between two positions.
 	bool aStarPath(const Position& origin, const Position& target, BattleUnit *missileTarget);
+	///Try to find a long path between two positions through the map blocks.
+	bool hierarchicalPath(const Position& origin, const Position& target);
+	/// Search the tiles reachable from a position without leaving an area.
+	void searchArea(const Position& origin, int minX, int minY, int maxX, int maxY, const Position *target, BattleUnit *unit);
+	/// Get the cost and path to a position found by the last search.
+	bool getSearchResult(const Position& pos, int *cost, std::vector<int> *path);
+	/// Drop the cached TU costs around tiles whose terrain changed.
+	void updateTUCostCache();
+	/// Check if a unit stands anywhere above or below a unit-sized area.
+	bool hasUnitsInColumns(const Position& pos, int size, BattleUnit *unit) const;
+	/// Get's the TU cost to move from 1 tile to the other, using the cache when possible.
+	int getCachedTUCost(const Position &startPosition, const int direction, Position *endPosition, BattleUnit *unit, BattleUnit *missileTarget);
+	friend class PathfindingGraph;
 public:
 	bool isBlocked(Tile *startTile, Tile *endTile, const int direction, BattleUnit *missileTarget);
 	static const int DIR_UP = 8;
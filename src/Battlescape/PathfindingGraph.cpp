@@ -0,0 +1,359 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include "PathfindingGraph.h"
+#include "Pathfinding.h"
+#include "../Savegame/SavedBattleGame.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Sets up a PathfindingGraph. The graph itself is built on first use.
+ * @param save Pointer to the battle to plan paths on.
+ * @param pathfinding Pointer to the pathfinding used to move between tiles.
+ */
+PathfindingGraph::PathfindingGraph(SavedBattleGame *save, Pathfinding *pathfinding) : _save(save), _pathfinding(pathfinding), _terrainChanges(0), _built(false)
+{
+	_blocksX = (_save->getWidth() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	_blocksY = (_save->getLength() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	_blocks.resize(_blocksX * _blocksY);
+}
+
+/**
+ * Deletes the PathfindingGraph.
+ */
+PathfindingGraph::~PathfindingGraph()
+{
+
+}
+
+/**
+ * Gets the block containing a position.
+ * @param pos Position on the map.
+ * @return Block index.
+ */
+int PathfindingGraph::getBlock(const Position &pos) const
+{
+	return (pos.y / BLOCK_SIZE) * _blocksX + pos.x / BLOCK_SIZE;
+}
+
+/**
+ * Checks if two blocks are the same or touch each other, even diagonally.
+ * @param a First block index.
+ * @param b Second block index.
+ * @return True if the blocks are within one block of each other.
+ */
+bool PathfindingGraph::areNeighbours(int a, int b) const
+{
+	return abs(a % _blocksX - b % _blocksX) <= 1 && abs(a / _blocksX - b / _blocksX) <= 1;
+}
+
+/**
+ * Gets the block next to another one.
+ * @param block Block index.
+ * @param direction One of the straight directions (0, 2, 4 or 6).
+ * @return Block index, -1 if that side is the map edge.
+ */
+int PathfindingGraph::getNeighbour(int block, int direction) const
+{
+	int x = block % _blocksX;
+	int y = block / _blocksX;
+	switch (direction)
+	{
+	case 0: --y; break;
+	case 2: ++x; break;
+	case 4: ++y; break;
+	case 6: --x; break;
+	}
+	if (x < 0 || x >= _blocksX || y < 0 || y >= _blocksY)
+		return -1;
+	return y * _blocksX + x;
+}
+
+/**
+ * Gets the area covered by a block, on every level of the map.
+ * @param block Block index.
+ * @param minX Pointer to the lowest X coordinate.
+ * @param minY Pointer to the lowest Y coordinate.
+ * @param maxX Pointer to the highest X coordinate.
+ * @param maxY Pointer to the highest Y coordinate.
+ */
+void PathfindingGraph::getBlockArea(int block, int *minX, int *minY, int *maxX, int *maxY) const
+{
+	*minX = (block % _blocksX) * BLOCK_SIZE;
+	*minY = (block / _blocksX) * BLOCK_SIZE;
+	*maxX = std::min(*minX + BLOCK_SIZE, _save->getWidth()) - 1;
+	*maxY = std::min(*minY + BLOCK_SIZE, _save->getLength()) - 1;
+}
+
+/**
+ * Finds where units can step from one side of a block into the neighbouring block.
+ * Each unbroken run of such steps along the side, on each level, gives one crossing
+ * in the middle of the run. Previous crossings on that side are replaced.
+ * @param block Block index.
+ * @param direction One of the straight directions (0, 2, 4 or 6).
+ * @param unit Unit whose movement the graph is built for.
+ */
+void PathfindingGraph::scanBorder(int block, int direction, BattleUnit *unit)
+{
+	std::vector<Crossing> &exits = _blocks[block].exits;
+	for (std::vector<Crossing>::iterator i = exits.begin(); i != exits.end();)
+	{
+		if (i->direction == direction)
+			i = exits.erase(i);
+		else
+			++i;
+	}
+	int neighbour = getNeighbour(block, direction);
+	if (neighbour == -1)
+		return;
+
+	int minX, minY, maxX, maxY;
+	getBlockArea(block, &minX, &minY, &maxX, &maxY);
+	bool alongX = (direction == 0 || direction == 4);
+	int first = alongX ? minX : minY;
+	int last = alongX ? maxX : maxY;
+	std::vector<Crossing> run;
+	for (int z = 0; z < _save->getHeight(); ++z)
+	{
+		for (int t = first; t <= last + 1; ++t)
+		{
+			bool open = false;
+			Crossing crossing;
+			if (t <= last)
+			{
+				Position pos;
+				switch (direction)
+				{
+				case 0: pos = Position(t, minY, z); break;
+				case 2: pos = Position(maxX, t, z); break;
+				case 4: pos = Position(t, maxY, z); break;
+				case 6: pos = Position(minX, t, z); break;
+				}
+				Position next;
+				int cost = _pathfinding->getCachedTUCost(pos, direction, &next, unit, 0);
+				if (cost < 255 && getBlock(next) == neighbour)
+				{
+					crossing.from = _save->getTileIndex(pos);
+					crossing.to = _save->getTileIndex(next);
+					crossing.direction = direction;
+					crossing.cost = cost;
+					open = true;
+				}
+			}
+			if (open)
+			{
+				run.push_back(crossing);
+			}
+			else if (!run.empty())
+			{
+				exits.push_back(run[run.size() / 2]);
+				run.clear();
+			}
+		}
+	}
+}
+
+/**
+ * Collects the tiles of a block that crossings leave from or arrive on,
+ * and drops the costs between them.
+ * @param block Block index.
+ */
+void PathfindingGraph::updatePortals(int block)
+{
+	Block &b = _blocks[block];
+	std::vector<int> portals;
+	for (std::vector<Crossing>::const_iterator i = b.exits.begin(); i != b.exits.end(); ++i)
+	{
+		portals.push_back(i->from);
+	}
+	for (int direction = 0; direction < 8; direction += 2)
+	{
+		int neighbour = getNeighbour(block, direction);
+		if (neighbour == -1)
+			continue;
+		const std::vector<Crossing> &entries = _blocks[neighbour].exits;
+		for (std::vector<Crossing>::const_iterator i = entries.begin(); i != entries.end(); ++i)
+		{
+			if (i->direction == (direction + 4) % 8)
+				portals.push_back(i->to);
+		}
+	}
+	std::sort(portals.begin(), portals.end());
+	portals.erase(std::unique(portals.begin(), portals.end()), portals.end());
+	b.portals.swap(portals);
+	b.tableReady = false;
+	b.costs.clear();
+	b.paths.clear();
+}
+
+/**
+ * Calculates the costs and paths between every pair of portals of a block,
+ * moving only through the block and ignoring units.
+ * @param block Block index.
+ * @param unit Unit whose movement the graph is built for.
+ */
+void PathfindingGraph::buildTable(int block, BattleUnit *unit)
+{
+	Block &b = _blocks[block];
+	int n = b.portals.size();
+	b.costs.assign(n * n, -1);
+	b.paths.assign(n * n, std::vector<int>());
+
+	bool ignoreUnits = _pathfinding->_ignoreUnits;
+	_pathfinding->_ignoreUnits = true;
+	int minX, minY, maxX, maxY;
+	getBlockArea(block, &minX, &minY, &maxX, &maxY);
+	for (int i = 0; i < n; ++i)
+	{
+		Position from;
+		_save->getTileCoords(b.portals[i], &from.x, &from.y, &from.z);
+		_pathfinding->searchArea(from, minX, minY, maxX, maxY, 0, unit);
+		for (int j = 0; j < n; ++j)
+		{
+			Position to;
+			_save->getTileCoords(b.portals[j], &to.x, &to.y, &to.z);
+			int cost;
+			if (_pathfinding->getSearchResult(to, &cost, &b.paths[i * n + j]))
+				b.costs[i * n + j] = cost;
+		}
+	}
+	_pathfinding->_ignoreUnits = ignoreUnits;
+	b.tableReady = true;
+}
+
+/**
+ * Builds the crossings of the whole map the first time, and afterwards
+ * rescans the sides of the blocks where the terrain changed since the last call,
+ * going by the battle's log of terrain changes. When the log doesn't go back far
+ * enough, the whole graph is built again.
+ * @param unit Unit whose movement the graph is built for.
+ */
+void PathfindingGraph::update(BattleUnit *unit)
+{
+	bool ignoreUnits = _pathfinding->_ignoreUnits;
+	_pathfinding->_ignoreUnits = true;
+	int blocks = _blocks.size();
+	std::vector<Position> changes;
+	if (_built && !_save->getTerrainChanges(&_terrainChanges, &changes))
+	{
+		_built = false;
+	}
+	if (!_built)
+	{
+		_terrainChanges = _save->getTerrainChangeCount();
+		for (int i = 0; i < blocks; ++i)
+		{
+			for (int direction = 0; direction < 8; direction += 2)
+			{
+				scanBorder(i, direction, unit);
+			}
+		}
+		for (int i = 0; i < blocks; ++i)
+		{
+			updatePortals(i);
+		}
+		_built = true;
+	}
+	else
+	{
+		std::vector<bool> dirty(blocks, false);
+		for (std::vector<Position>::const_iterator i = changes.begin(); i != changes.end(); ++i)
+		{
+			dirty[getBlock(*i)] = true;
+		}
+		if (!changes.empty())
+		{
+			std::vector<bool> touched(blocks, false);
+			for (int i = 0; i < blocks; ++i)
+			{
+				if (!dirty[i])
+					continue;
+				touched[i] = true;
+				for (int direction = 0; direction < 8; direction += 2)
+				{
+					scanBorder(i, direction, unit);
+					int neighbour = getNeighbour(i, direction);
+					if (neighbour != -1)
+					{
+						scanBorder(neighbour, (direction + 4) % 8, unit);
+						touched[neighbour] = true;
+					}
+				}
+			}
+			for (int i = 0; i < blocks; ++i)
+			{
+				if (touched[i])
+					updatePortals(i);
+			}
+		}
+	}
+	_pathfinding->_ignoreUnits = ignoreUnits;
+}
+
+/**
+ * Gets the tile indices of the portals of a block.
+ * @param block Block index.
+ * @return Sorted tile indices.
+ */
+const std::vector<int> &PathfindingGraph::getPortals(int block) const
+{
+	return _blocks[block].portals;
+}
+
+/**
+ * Gets the crossings leaving a block.
+ * @param block Block index.
+ * @return List of crossings.
+ */
+const std::vector<PathfindingGraph::Crossing> &PathfindingGraph::getExits(int block) const
+{
+	return _blocks[block].exits;
+}
+
+/**
+ * Gets the TU cost between two portals of a block, calculating the block's table if needed.
+ * @param block Block index.
+ * @param from Index of the first portal in the block's portal list.
+ * @param to Index of the second portal in the block's portal list.
+ * @param unit Unit whose movement the graph is built for.
+ * @return TU cost, -1 if there is no path inside the block.
+ */
+int PathfindingGraph::getPortalCost(int block, int from, int to, BattleUnit *unit)
+{
+	if (!_blocks[block].tableReady)
+		buildTable(block, unit);
+	return _blocks[block].costs[from * _blocks[block].portals.size() + to];
+}
+
+/**
+ * Gets the path between two portals of a block. Only valid after getPortalCost.
+ * @param block Block index.
+ * @param from Index of the first portal in the block's portal list.
+ * @param to Index of the second portal in the block's portal list.
+ * @return Directions to walk, in order.
+ */
+const std::vector<int> &PathfindingGraph::getPortalPath(int block, int from, int to) const
+{
+	return _blocks[block].paths[from * _blocks[block].portals.size() + to];
+}
+
+}
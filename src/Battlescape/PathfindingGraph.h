@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_PATHFINDINGGRAPH_H
+#define OPENXCOM_PATHFINDINGGRAPH_H
+
+#include <vector>
+#include "Position.h"
+
+namespace OpenXcom
+{
+
+class SavedBattleGame;
+class Pathfinding;
+class BattleUnit;
+
+/**
+ * An abstract graph of the battlescape map used to plan long paths.
+ * The map is split in columns of MapBlock size, and the places where units can
+ * cross from one column to the next become the nodes of the graph. The costs
+ * and paths between the nodes of a column are calculated on demand, ignoring
+ * units, and patched when the terrain of the column changes.
+ */
+class PathfindingGraph
+{
+public:
+	/// A step from the edge of a block into the next block.
+	struct Crossing
+	{
+		int from, to, direction, cost;
+	};
+	static const int BLOCK_SIZE = 10;
+private:
+	struct Block
+	{
+		std::vector<Crossing> exits;
+		std::vector<int> portals;
+		bool tableReady;
+		std::vector<int> costs;
+		std::vector<std::vector<int> > paths;
+	};
+	SavedBattleGame *_save;
+	Pathfinding *_pathfinding;
+	int _blocksX, _blocksY;
+	std::vector<Block> _blocks;
+	int _terrainChanges;
+	bool _built;
+	/// Finds the crossings on one side of a block.
+	void scanBorder(int block, int direction, BattleUnit *unit);
+	/// Collects the tiles of a block that crossings start or end on.
+	void updatePortals(int block);
+	/// Calculates the costs and paths between the portals of a block.
+	void buildTable(int block, BattleUnit *unit);
+	/// Gets the block next to another one.
+	int getNeighbour(int block, int direction) const;
+public:
+	/// Creates a new PathfindingGraph.
+	PathfindingGraph(SavedBattleGame *save, Pathfinding *pathfinding);
+	/// Cleans up the PathfindingGraph.
+	~PathfindingGraph();
+	/// Builds the graph or patches the blocks whose terrain changed.
+	void update(BattleUnit *unit);
+	/// Gets the block containing a position.
+	int getBlock(const Position &pos) const;
+	/// Checks if two blocks are the same or touch each other.
+	bool areNeighbours(int a, int b) const;
+	/// Gets the area covered by a block.
+	void getBlockArea(int block, int *minX, int *minY, int *maxX, int *maxY) const;
+	/// Gets the tile indices of the portals of a block.
+	const std::vector<int> &getPortals(int block) const;
+	/// Gets the crossings leaving a block.
+	const std::vector<Crossing> &getExits(int block) const;
+	/// Gets the cost between two portals of a block.
+	int getPortalCost(int block, int from, int to, BattleUnit *unit);
+	/// Gets the path between two portals of a block.
+	const std::vector<int> &getPortalPath(int block, int from, int to) const;
+};
+
+}
+
+#endif
@@ -25,7 +25,6 @@ namespace OpenXcom
 {
 
 class PathfindingOpenSet;
-class OpenSetEntry;
 
 /**
  * A class that holds pathfinding info for a certain node on the map.
@@ -34,14 +33,16 @@ class PathfindingNode
 {
 private:
 	Position _pos;
-	bool _checked;
 	int _tuCost;
-	PathfindingNode* _prevNode;
-	int _prevDir;
 	/// Approximate cost to reach goal position.
 	int _tuGuess;
-	// Invasive field needed by PathfindingOpenSet
-	OpenSetEntry *_openentry;
+	PathfindingNode* _prevNode;
+	/// Search this node was last reset for.
+	unsigned int _generation;
+	// Invasive field needed by PathfindingOpenSet, -1 when not in the set
+	int _openIndex;
+	signed char _prevDir;
+	bool _checked;
 	friend class PathfindingOpenSet;
 public:
 	/// Creates a new PathfindingNode class
@@ -51,7 +52,11 @@ public:
 	/// Get the node position
 	const Position &getPosition() const;
 	/// Reset node.
-	void reset();
+	void reset(unsigned int generation);
+	/// Reset node if it was last used by an older search.
+	void refresh(unsigned int generation) { if (_generation != generation) reset(generation); }
+	/// Was the node reached by a search?
+	bool isCurrent(unsigned int generation) const { return _generation == generation; }
 	/// is checked?
 	bool isChecked() const;
 	/// Mark as checked
@@ -65,7 +70,7 @@ public:
 	/// get previous walking direction
 	int getPrevDir() const;
 	/// Is this node already in a PathfindingOpenSet?
-	bool inOpenSet() const { return _openentry; }
+	bool inOpenSet() const { return _openIndex != -1; }
 	/// Get approximate cost to reach target position.
 	int getTUGuess() const { return _tuGuess; }
 	/// Connect to previous node along the path.
@@ -16,6 +16,7 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <cassert>
 #include "PathfindingOpenSet.h"
 #include "PathfindingNode.h"
 
@@ -23,27 +24,80 @@ namespace OpenXcom
 {
 
 /**
- * Cleans up all the entries still in set.
+ * Cleans up the set. The nodes are owned by the Pathfinding.
  */
 PathfindingOpenSet::~PathfindingOpenSet()
 {
-	while (!_queue.empty())
+
+}
+
+/**
+ * Remove all nodes from the set, keeping the allocated storage for the next search.
+ */
+void PathfindingOpenSet::clear()
+{
+	for (std::vector<PathfindingNode*>::iterator i = _heap.begin(); i != _heap.end(); ++i)
 	{
-		delete _queue.top();
-		_queue.pop();
+		(*i)->_openIndex = -1;
 	}
+	_heap.clear();
 }
 
 /**
- * Keep removing all discarded entries that have come to the top of the queue.
+ * Get the cost of a node, the lowest cost comes out first.
+ * @param node Pointer to the node.
+ * @return Known cost plus estimated remaining cost.
  */
-void PathfindingOpenSet::removeDiscarded()
+int PathfindingOpenSet::getCost(const PathfindingNode *node)
 {
-	while (!_queue.empty() && !_queue.top()->_node)
+	return node->_tuCost + node->_tuGuess;
+}
+
+/**
+ * Move the entry at @a index towards the root until its parent costs no more than it does.
+ * @param index Heap index of the entry.
+ */
+void PathfindingOpenSet::siftUp(int index)
+{
+	PathfindingNode *node = _heap[index];
+	int cost = getCost(node);
+	while (index > 0)
 	{
-		delete _queue.top();
-		_queue.pop();
+		int parent = (index - 1) / 2;
+		if (getCost(_heap[parent]) <= cost)
+			break;
+		_heap[index] = _heap[parent];
+		_heap[index]->_openIndex = index;
+		index = parent;
 	}
+	_heap[index] = node;
+	node->_openIndex = index;
+}
+
+/**
+ * Move the entry at @a index towards the leaves until none of its children cost less than it does.
+ * @param index Heap index of the entry.
+ */
+void PathfindingOpenSet::siftDown(int index)
+{
+	int size = _heap.size();
+	PathfindingNode *node = _heap[index];
+	int cost = getCost(node);
+	while (true)
+	{
+		int child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && getCost(_heap[child + 1]) < getCost(_heap[child]))
+			++child;
+		if (getCost(_heap[child]) >= cost)
+			break;
+		_heap[index] = _heap[child];
+		_heap[index]->_openIndex = index;
+		index = child;
+	}
+	_heap[index] = node;
+	node->_openIndex = index;
 }
 
 /**
@@ -54,31 +108,35 @@ void PathfindingOpenSet::removeDiscarded()
 PathfindingNode *PathfindingOpenSet::pop()
 {
 	assert(!empty());
-	PathfindingNode *nd = _queue.top()->_node;
-	delete _queue.top();
-	_queue.pop();
-	nd->_openentry = 0;
-
-	// Discarded entries might be visible now.
-	removeDiscarded();
+	PathfindingNode *nd = _heap.front();
+	nd->_openIndex = -1;
+	PathfindingNode *last = _heap.back();
+	_heap.pop_back();
+	if (!_heap.empty())
+	{
+		_heap.front() = last;
+		siftDown(0);
+	}
 	return nd;
 }
 
 /**
  * Place the node in the set.
- * If the node was already in the set, the previous entry is discarded.
+ * If the node was already in the set, its entry is moved to match the new cost.
  * It is the caller's responsibility to never re-add a node with a worse cost.
  * @param node A pointer to the node to add.
  */
 void PathfindingOpenSet::push(PathfindingNode *node)
 {
-	OpenSetEntry *entry = new OpenSetEntry;
-	entry->_node = node;
-	entry->_cost = node->getTUCost(false) + node->getTUGuess();
-	if (node->_openentry)
-		node->_openentry->_node = 0;
-	node->_openentry = entry;
-	_queue.push(entry);
+	if (node->_openIndex == -1)
+	{
+		_heap.push_back(node);
+		siftUp(_heap.size() - 1);
+	}
+	else
+	{
+		siftUp(node->_openIndex);
+	}
 }
 
 
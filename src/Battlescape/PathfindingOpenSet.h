@@ -19,57 +19,43 @@
 #ifndef OPENXCOM_PATHFINDINGOPENSET_H
 #define OPENXCOM_PATHFINDINGOPENSET_H
 
-#include <queue>
+#include <vector>
 
 namespace OpenXcom
 {
 
 class PathfindingNode;
 
-struct OpenSetEntry
-{
-	int _cost;
-	PathfindingNode *_node;
-};
-
-/**
- * Helper class to compare entries through pointers.
- */
-class EntryCompare
-{
-public:
- 	/**
-	 * Compare entries @a *a and @a *b.
-         * @param a Pointer to first entry.
-         * @param b Pointer to second entry.
-	 * @return true If entry @a *b must come before @a *a.
-	 */
-	bool operator()(OpenSetEntry *a, OpenSetEntry *b) const
-	{
-		return b->_cost < a->_cost;
-	}
-};
-
 /**
  * A class that holds references to the nodes to be examined in pathfinding.
+ * The nodes are kept in a binary heap ordered by estimated total cost, and each
+ * node remembers its place in the heap, so a node found again through a better
+ * path is moved up in place instead of being added twice. The heap storage is
+ * kept between searches.
  */
 class PathfindingOpenSet
 {
 public:
-	/// Cleanup the set and free allocated memory.
+	/// Cleans up the set.
 	~PathfindingOpenSet();
 	/// Get the next node to check.
 	PathfindingNode *pop();
 	/// Add a node in the set.
 	void push(PathfindingNode *node);
 	/// Is the set empty?
-	bool empty() const { return _queue.empty(); }
+	bool empty() const { return _heap.empty(); }
+	/// Remove all nodes from the set.
+	void clear();
 
 private:
-	std::priority_queue<OpenSetEntry*, std::vector<OpenSetEntry*>, EntryCompare> _queue;
-
-	/// Remove reachable discarded entries.
-	void removeDiscarded();
+	std::vector<PathfindingNode*> _heap;
+
+	/// Get the cost a node is sorted by.
+	static int getCost(const PathfindingNode *node);
+	/// Move an entry up towards the root.
+	void siftUp(int index);
+	/// Move an entry down towards the leaves.
+	void siftDown(int index);
 };
 
 }
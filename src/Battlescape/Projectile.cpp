@@ -273,7 +273,7 @@ bool Projectile::calculateThrow(double accuracy)
 	static const double maxDeviation = 0.08;
 	static const double minDeviation = 0;
 	double baseDeviation = (maxDeviation - (maxDeviation * accuracy)) + minDeviation;
-	double deviation = RNG::boxMuller(0, baseDeviation);
+	double deviation = RNG::boxMuller(RNG::BATTLESCAPE, 0, baseDeviation);
 
 	_trajectory.clear();
 	// finally do a line calculation and store this trajectory.
@@ -336,7 +336,7 @@ void Projectile::applyAccuracy(const Position& origin, Position *target, double
 	double baseDeviation = (maxDeviation - (maxDeviation * accuracy)) + minDeviation;
 	// the angle deviations are spread using a normal distribution between 0 and baseDeviation
 	// check if we hit
-	if (RNG::generate(0.0, 1.0) < accuracy)
+	if (RNG::generate(RNG::BATTLESCAPE, 0.0, 1.0) < accuracy)
 	{
 		// we hit, so no deviation
 		dRot = 0;
@@ -344,8 +344,8 @@ void Projectile::applyAccuracy(const Position& origin, Position *target, double
 	}
 	else
 	{
-		dRot = RNG::boxMuller(0, baseDeviation);
-		dTilt = RNG::boxMuller(0, baseDeviation / 2.0); // tilt deviation is halved
+		dRot = RNG::boxMuller(RNG::BATTLESCAPE, 0, baseDeviation);
+		dTilt = RNG::boxMuller(RNG::BATTLESCAPE, 0, baseDeviation / 2.0); // tilt deviation is halved
 	}
 	rotation = atan2(double(target->y - origin.y), double(target->x - origin.x)) * 180 / M_PI;
 	tilt = atan2(double(target->z - origin.z),
@@ -18,7 +18,8 @@
  */
 #define _USE_MATH_DEFINES
 #include <cmath>
-#include <set>
+#include <algorithm>
+#include <iterator>
 #include "TileEngine.h"
 #include <SDL.h>
 #include "BattleAIState.h"
@@ -36,6 +37,7 @@
 #include "../Resource/ResourcePack.h"
 #include "Pathfinding.h"
 #include "../Engine/Options.h"
+#include "../Engine/ThreadPool.h"
 
 namespace OpenXcom
 {
@@ -44,9 +46,30 @@ namespace OpenXcom
  * Sets up a TileEngine.
  * @param save pointer to SavedBattleGame object.
  */
-TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _personalLighting(true)
+TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _lightFalloffRange(-1), _explosionGeneration(0), _threadPool(0), _personalLighting(true)
 {
-
+	if (Options::getInt("battleWorkerThreads") > 0)
+	{
+		_threadPool = new ThreadPool(Options::getInt("battleWorkerThreads"));
+	}
+	int tiles = _save->getWidth() * _save->getLength() * _save->getHeight();
+	_terrainVoxelSlot.resize(tiles, -1);
+	_terrainVoxelVersion.resize(tiles, -1);
+	_lightDirty.resize(_save->getWidth() * _save->getLength());
+	_explosionVisited.resize(tiles, 0);
+	for (int fi = -90; fi <= 90; fi += 10)
+	{
+		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
+		for (int te = 0; te <= 360; te += 3)
+		{
+			ExplosionRay ray;
+			ray.cosTe = cos(te * M_PI / 180.0);
+			ray.sinTe = sin(te * M_PI / 180.0);
+			ray.sinFi = sin(fi * M_PI / 180.0);
+			_explosionRays.push_back(ray);
+		}
+	}
+	_viewTerrainChanges = _save->getTerrainChangeCount();
 }
 
 /**
@@ -54,7 +77,7 @@ TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) :
  */
 TileEngine::~TileEngine()
 {
-
+	delete _threadPool;
 }
 
 
@@ -62,13 +85,43 @@ TileEngine::~TileEngine()
   * Calculate sun shading for the whole terrain.
   */
 void TileEngine::calculateSunShading()
+{
+	for (int y = 0; y < _save->getLength(); ++y)
+	{
+		for (int x = 0; x < _save->getWidth(); ++x)
+		{
+			calculateSunShading(x, y);
+		}
+	}
+}
+
+/**
+  * Calculate sun shading for a column of tiles in a single sweep from the top level down,
+  * keeping track of how much the floors above block the sun.
+  * Gives the same result as calculating each tile of the column on its own.
+  * @param x X position of the column.
+  * @param y Y position of the column.
+  */
+void TileEngine::calculateSunShading(int x, int y)
 {
 	const int layer = 0; // Ambient lighting layer.
 
-	for (int i = 0; i < _save->getWidth() * _save->getLength() * _save->getHeight(); ++i)
+	int power = 15 - _save->getGlobalShade();
+	int block = 0;
+	for (int z = _save->getHeight() - 1; z >= 0; --z)
 	{
-		_save->getTiles()[i]->resetLight(layer);
-		calculateSunShading(_save->getTiles()[i]);
+		Tile *tile = _save->getTile(Position(x, y, z));
+		tile->resetLight(layer);
+		// At night/dusk sun isn't dropping shades blocked by roofs
+		if (_save->getGlobalShade() <= 4 && block)
+		{
+			tile->addLight(power - 2, layer);
+		}
+		else
+		{
+			tile->addLight(power, layer);
+		}
+		block += blockage(tile, MapData::O_FLOOR, DT_NONE);
 	}
 }
 
@@ -96,65 +149,114 @@ void TileEngine::calculateSunShading(Tile *tile)
 
 /**
   * Recalculate lighting for the terrain: objects,items,fire.
+  * Only the areas around light sources that changed are relit.
   */
 void TileEngine::calculateTerrainLighting()
 {
 	const int layer = 1; // Static lighting layer.
-	const int fireLightPower = 15; // amount of light a fire generates
 
-	// reset all light to 0 first
+	std::vector<LightSource> lights;
 	for (int i = 0; i < _save->getWidth() * _save->getLength() * _save->getHeight(); ++i)
 	{
-		_save->getTiles()[i]->resetLight(layer);
+		addTerrainLights(_save->getTiles()[i], &lights);
 	}
 
-	// add lighting of terrain
-	for (int i = 0; i < _save->getWidth() * _save->getLength() * _save->getHeight(); ++i)
+	updateLighting(&_terrainLights, lights, layer);
+}
+
+/**
+  * Recalculate lighting for the terrain, only looking for changed light
+  * sources in the columns of the given tiles, so the rest of the map
+  * doesn't need to be searched.
+  * @param tiles Tiles that could have gained or lost light sources.
+  */
+void TileEngine::calculateTerrainLighting(const std::vector<Tile*> &tiles)
+{
+	const int layer = 1; // Static lighting layer.
+	const int width = _save->getWidth(), length = _save->getLength();
+
+	std::vector<int> columns;
+	for (std::vector<Tile*>::const_iterator i = tiles.begin(); i != tiles.end(); ++i)
 	{
-		// only floors and objects can light up
-		if (_save->getTiles()[i]->getMapData(MapData::O_FLOOR)
-			&& _save->getTiles()[i]->getMapData(MapData::O_FLOOR)->getLightSource())
+		columns.push_back((*i)->getPosition().y * width + (*i)->getPosition().x);
+	}
+	std::sort(columns.begin(), columns.end());
+	columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+	// keep the light sources of the other columns, and look again in these ones
+	std::vector<LightSource> lights;
+	for (std::vector<LightSource>::const_iterator i = _terrainLights.begin(); i != _terrainLights.end(); ++i)
+	{
+		if (!std::binary_search(columns.begin(), columns.end(), i->y * width + i->x))
 		{
-			addLight(_save->getTiles()[i]->getPosition(), _save->getTiles()[i]->getMapData(MapData::O_FLOOR)->getLightSource(), layer);
+			lights.push_back(*i);
 		}
-		if (_save->getTiles()[i]->getMapData(MapData::O_OBJECT)
-			&& _save->getTiles()[i]->getMapData(MapData::O_OBJECT)->getLightSource())
+	}
+	for (std::vector<int>::const_iterator i = columns.begin(); i != columns.end(); ++i)
+	{
+		for (int z = 0; z < _save->getHeight(); ++z)
 		{
-			addLight(_save->getTiles()[i]->getPosition(), _save->getTiles()[i]->getMapData(MapData::O_OBJECT)->getLightSource(), layer);
+			addTerrainLights(_save->getTiles()[z * width * length + *i], &lights);
 		}
+	}
 
-		// fires
-		if (_save->getTiles()[i]->getFire())
-		{
-			addLight(_save->getTiles()[i]->getPosition(), fireLightPower, layer);
-		}
+	updateLighting(&_terrainLights, lights, layer);
+}
 
-		for (std::vector<BattleItem*>::iterator it = _save->getTiles()[i]->getInventory()->begin(); it != _save->getTiles()[i]->getInventory()->end(); ++it)
-		{
-			if ((*it)->getRules()->getBattleType() == BT_FLARE)
-			{
-				addLight(_save->getTiles()[i]->getPosition(), (*it)->getRules()->getPower(), layer);
-			}
-		}
+/**
+  * Adds the light sources of a tile to a list.
+  * @param tile The tile to look at.
+  * @param lights Pointer to the list of light sources.
+  */
+void TileEngine::addTerrainLights(Tile *tile, std::vector<LightSource> *lights) const
+{
+	const int fireLightPower = 15; // amount of light a fire generates
+
+	LightSource light;
+	light.x = tile->getPosition().x;
+	light.y = tile->getPosition().y;
+
+	// only floors and objects can light up
+	if (tile->getMapData(MapData::O_FLOOR)
+		&& tile->getMapData(MapData::O_FLOOR)->getLightSource())
+	{
+		light.power = tile->getMapData(MapData::O_FLOOR)->getLightSource();
+		lights->push_back(light);
+	}
+	if (tile->getMapData(MapData::O_OBJECT)
+		&& tile->getMapData(MapData::O_OBJECT)->getLightSource())
+	{
+		light.power = tile->getMapData(MapData::O_OBJECT)->getLightSource();
+		lights->push_back(light);
+	}
 
+	// fires
+	if (tile->getFire())
+	{
+		light.power = fireLightPower;
+		lights->push_back(light);
 	}
 
+	for (std::vector<BattleItem*>::iterator it = tile->getInventory()->begin(); it != tile->getInventory()->end(); ++it)
+	{
+		if ((*it)->getRules()->getBattleType() == BT_FLARE)
+		{
+			light.power = (*it)->getRules()->getPower();
+			lights->push_back(light);
+		}
+	}
 }
 
 /**
   * Recalculate lighting for the units.
+  * Only the areas around units that moved are relit.
   */
 void TileEngine::calculateUnitLighting()
 {
 	const int layer = 2; // Dynamic lighting layer.
 	const int personalLightPower = 15; // amount of light a unit generates
 
-	// reset all light to 0 first
-	for (int i = 0; i < _save->getWidth() * _save->getLength() * _save->getHeight(); ++i)
-	{
-		_save->getTiles()[i]->resetLight(layer);
-	}
-
+	std::vector<LightSource> lights;
 	if (_personalLighting)
 	{
 		// add lighting of soldiers
@@ -162,46 +264,161 @@ void TileEngine::calculateUnitLighting()
 		{
 			if ((*i)->getFaction() == FACTION_PLAYER && !(*i)->isOut())
 			{
-				addLight((*i)->getPosition(), personalLightPower, layer);
+				LightSource light;
+				light.x = (*i)->getPosition().x;
+				light.y = (*i)->getPosition().y;
+				light.power = personalLightPower;
+				lights.push_back(light);
 			}
 		}
 	}
+
+	updateLighting(&_unitLights, lights, layer);
 }
 
 /**
- * Adds circular light pattern starting from center and loosing power with distance travelled.
- * @param center
- * @param power
+ * Orders light sources by position and power, so two lists can be compared.
+ * @param other Light source to compare with.
+ * @return True if this light source comes first.
+ */
+bool TileEngine::LightSource::operator<(const LightSource &other) const
+{
+	if (x != other.x)
+		return x < other.x;
+	if (y != other.y)
+		return y < other.y;
+	return power < other.power;
+}
+
+/**
+ * Brings a lighting layer up to date with a new list of light sources.
+ * The columns reached by any source that was added or removed are
+ * reset, then lit again by every source reaching them. The rest of
+ * the map keeps its light.
+ * @param lights Pointer to the current light sources of the layer, replaced by the new ones.
+ * @param newLights New light sources of the layer, gets sorted.
  * @param layer Light is seperated in 3 layers: Ambient, Static and Dynamic.
  */
-void TileEngine::addLight(const Position &center, int power, int layer)
+void TileEngine::updateLighting(std::vector<LightSource> *lights, std::vector<LightSource> &newLights, int layer)
 {
-	// only loop through the positive quadrant.
-	for (int x = 0; x <= power; ++x)
+	std::sort(newLights.begin(), newLights.end());
+	std::vector<LightSource> changed;
+	std::set_symmetric_difference(lights->begin(), lights->end(), newLights.begin(), newLights.end(), std::back_inserter(changed));
+	if (changed.empty())
+	{
+		return;
+	}
+
+	const int width = _save->getWidth(), length = _save->getLength(), height = _save->getHeight();
+	int minX = width, maxX = -1, minY = length, maxY = -1;
+	std::fill(_lightDirty.begin(), _lightDirty.end(), false);
+	for (std::vector<LightSource>::const_iterator i = changed.begin(); i != changed.end(); ++i)
 	{
-		for (int y = 0; y <= power; ++y)
+		int x1 = std::max(i->x - i->power, 0), x2 = std::min(i->x + i->power, width - 1);
+		int y1 = std::max(i->y - i->power, 0), y2 = std::min(i->y + i->power, length - 1);
+		for (int y = y1; y <= y2; ++y)
 		{
-			for (int z = 0; z < _save->getHeight(); z++)
+			for (int x = x1; x <= x2; ++x)
 			{
-				int distance = int(floor(sqrt(float(x*x + y*y)) + 0.5));
+				int column = y * width + x;
+				if (!_lightDirty[column])
+				{
+					_lightDirty[column] = true;
+					for (int z = 0; z < height; ++z)
+					{
+						_save->getTiles()[z * width * length + column]->resetLight(layer);
+					}
+				}
+			}
+		}
+		minX = std::min(minX, x1);
+		maxX = std::max(maxX, x2);
+		minY = std::min(minY, y1);
+		maxY = std::max(maxY, y2);
+	}
 
-				if (_save->getTile(Position(center.x + x,center.y + y, z)))
-					_save->getTile(Position(center.x + x,center.y + y, z))->addLight(power - distance, layer);
+	for (std::vector<LightSource>::const_iterator i = newLights.begin(); i != newLights.end(); ++i)
+	{
+		addLight(*i, layer, minX, maxX, minY, maxY);
+	}
+	lights->swap(newLights);
+}
 
-				if (_save->getTile(Position(center.x - x,center.y - y, z)))
-					_save->getTile(Position(center.x - x,center.y - y, z))->addLight(power - distance, layer);
+/**
+ * Adds circular light pattern starting from center and loosing power with distance travelled.
+ * Only columns marked as dirty inside the given area are lit.
+ * @param light Light source.
+ * @param layer Light is seperated in 3 layers: Ambient, Static and Dynamic.
+ * @param minX Left of the area to light.
+ * @param maxX Right of the area to light.
+ * @param minY Top of the area to light.
+ * @param maxY Bottom of the area to light.
+ */
+void TileEngine::addLight(const LightSource &light, int layer, int minX, int maxX, int minY, int maxY)
+{
+	const int width = _save->getWidth(), length = _save->getLength(), height = _save->getHeight();
+	int x1 = std::max(light.x - light.power, minX), x2 = std::min(light.x + light.power, maxX);
+	int y1 = std::max(light.y - light.power, minY), y2 = std::min(light.y + light.power, maxY);
+	if (x1 > x2 || y1 > y2)
+	{
+		return;
+	}
 
-				if (_save->getTile(Position(center.x - x,center.y + y, z)))
-					_save->getTile(Position(center.x - x,center.y + y, z))->addLight(power - distance, layer);
+	// the distance falloff only depends on the offset, so keep a table of it
+	if (light.power > _lightFalloffRange)
+	{
+		_lightFalloffRange = light.power;
+		_lightFalloff.resize((_lightFalloffRange + 1) * (_lightFalloffRange + 1));
+		for (int x = 0; x <= _lightFalloffRange; ++x)
+		{
+			for (int y = 0; y <= _lightFalloffRange; ++y)
+			{
+				_lightFalloff[y * (_lightFalloffRange + 1) + x] = int(floor(sqrt(float(x*x + y*y)) + 0.5));
+			}
+		}
+	}
 
-				if (_save->getTile(Position(center.x + x,center.y - y, z)))
-					_save->getTile(Position(center.x + x,center.y - y, z))->addLight(power - distance, layer);
+	for (int y = y1; y <= y2; ++y)
+	{
+		for (int x = x1; x <= x2; ++x)
+		{
+			int column = y * width + x;
+			if (!_lightDirty[column])
+				continue;
+			int power = light.power - _lightFalloff[abs(y - light.y) * (_lightFalloffRange + 1) + abs(x - light.x)];
+			if (power <= 0)
+				continue;
+			for (int z = 0; z < height; ++z)
+			{
+				_save->getTiles()[z * width * length + column]->addLight(power, layer);
 			}
 		}
 	}
 }
 
 
+/**
+ * Runs the field of view calculation of several units on the worker threads.
+ */
+class TileEngine::ViewJob : public ThreadPool::Job
+{
+private:
+	TileEngine *_engine;
+	const std::vector<BattleUnit*> &_units;
+	const std::vector<ViewCache*> &_views;
+	bool _turret;
+public:
+	/// Creates a job for a list of units.
+	ViewJob(TileEngine *engine, const std::vector<BattleUnit*> &units, const std::vector<ViewCache*> &views, bool turret) : _engine(engine), _units(units), _views(views), _turret(turret)
+	{
+	}
+	/// Calculates the field of view of one unit.
+	void run(int index)
+	{
+		_engine->computeFOV(_units[index], _views[index], _turret);
+	}
+};
+
 /**
  * Calculates line of sight of a soldier.
  * @param unit
@@ -209,12 +426,85 @@ void TileEngine::addLight(const Position &center, int power, int layer)
  */
 bool TileEngine::calculateFOV(BattleUnit *unit)
 {
-	size_t visibleUnitsChecksum = 0, oldNumVisibleUnits = 0;
+	if (unit->getFaction() == FACTION_PLAYER)
+	{
+		updateDirtyTiles();
+	}
+	ViewCache *view = &_viewCache[unit];
+	computeFOV(unit, view, Options::getBool("strafe"));
+	return applyFOV(unit, view);
+}
+
+/**
+ * Calculates line of sight of several units at once. The units are looked at in parallel when there
+ * are worker threads, but the results are applied in the order of the list, so the outcome is
+ * the same as calling calculateFOV() for each unit.
+ * @param units The units to calculate the field of view for.
+ */
+void TileEngine::calculateFOV(const std::vector<BattleUnit*> &units)
+{
+	if (_threadPool == 0 || units.size() < 2)
+	{
+		for (std::vector<BattleUnit*>::const_iterator i = units.begin(); i != units.end(); ++i)
+		{
+			calculateFOV(*i);
+		}
+		return;
+	}
+
+	// everything the worker threads share has to be up to date before they start,
+	// which for the terrain voxels is every tile within view range of the units
+	updateDirtyTiles();
+	for (std::vector<BattleUnit*>::const_iterator i = units.begin(); i != units.end(); ++i)
+	{
+		if ((*i)->isOut())
+			continue;
+		Position pos = (*i)->getPosition();
+		int range = MAX_VIEW_DISTANCE + (*i)->getArmor()->getSize() + 1;
+		int minX = std::max(0, pos.x - range), maxX = std::min(_save->getWidth() - 1, pos.x + range);
+		int minY = std::max(0, pos.y - range), maxY = std::min(_save->getLength() - 1, pos.y + range);
+		for (int z = 0; z < _save->getHeight(); ++z)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				for (int x = minX; x <= maxX; ++x)
+				{
+					int index = _save->getTileIndex(Position(x, y, z));
+					getTerrainVoxels(index, _save->getTiles()[index]);
+				}
+			}
+		}
+	}
+	std::vector<ViewCache*> views;
+	for (std::vector<BattleUnit*>::const_iterator i = units.begin(); i != units.end(); ++i)
+	{
+		views.push_back(&_viewCache[*i]);
+	}
+
+	ViewJob job(this, units, views, Options::getBool("strafe"));
+	_threadPool->execute(&job, units.size());
+
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		applyFOV(units[i], views[i]);
+	}
+}
+
+/**
+ * Works out what a unit can see, without changing the units or tiles: the spotted units and the tiles in sight are stored in the view.
+ * The terrain visibility of player units is cached: when the unit did not move or turn since the last call,
+ * only the lines of sight that pass near terrain that changed in the meantime are traced again.
+ * @param unit The unit looking around.
+ * @param view The view of the unit.
+ * @param turret Does a turret determine the direction a unit looks at?
+ */
+void TileEngine::computeFOV(BattleUnit *unit, ViewCache *view, bool turret)
+{
 	Position center = unit->getPosition();
 	Position test;
 	int direction;
 	bool swap;
-	if (Options::getBool("strafe") && (unit->getTurretType() > -1)) {
+	if (turret && (unit->getTurretType() > -1)) {
 		direction = unit->getTurretDirection();
 	}
 	else
@@ -226,21 +516,45 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 	int signY[8] = { -1, -1, -1, +1, +1, +1, -1, -1 };
 	int y1, y2;
 
-	// calculate a visible units checksum - if it changed during this step, the soldier stops walking
-	// the unit's Xposition * 100 + y seems a simple but unique ID for each unit
-	for (std::vector<BattleUnit*>::iterator i = unit->getVisibleUnits()->begin(); i != unit->getVisibleUnits()->end(); ++i)
-		visibleUnitsChecksum += (*i)->getPosition().x*100 + (*i)->getPosition().y;
-
-	oldNumVisibleUnits = unit->getVisibleUnits()->size();
-
-	unit->clearVisibleUnits();
-	unit->clearVisibleTiles();
+	view->spotted.clear();
+	view->tiles.clear();
 
 	if (unit->isOut())
-		return false;
+		return;
 	Position pos = unit->getPosition();
 	if ((unit->getHeight() + -_save->getTile(unit->getPosition())->getTerrainLevel()) > 24)
 		++pos.z;
+	int size = unit->getArmor()->getSize();
+
+	// find out which of the previously traced lines of sight are still valid
+	bool player = unit->getFaction() == FACTION_PLAYER;
+	bool reuse = false;
+	std::vector<Position> dirty;
+	if (player)
+	{
+		reuse = !view->cells.empty() && view->position == center && view->eyes == pos && view->direction == direction && view->size == size;
+		if (reuse)
+		{
+			for (size_t i = view->dirtyTiles; i < _dirtyTiles.size(); ++i)
+			{
+				if (distance(_dirtyTiles[i], pos) <= MAX_VIEW_DISTANCE + size + 1)
+				{
+					dirty.push_back(_dirtyTiles[i]);
+				}
+			}
+		}
+		else
+		{
+			view->position = center;
+			view->eyes = pos;
+			view->direction = direction;
+			view->size = size;
+			view->cells.clear();
+		}
+		view->dirtyTiles = _dirtyTiles.size();
+	}
+	size_t cell = 0;
+
 	for (int x = 0; x <= MAX_VIEW_DISTANCE; ++x)
 	{
 		if (direction%2)
@@ -263,59 +577,109 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 				{
 					test.x = center.x + signX[direction]*(swap?y:x);
 					test.y = center.y + signY[direction]*(swap?x:y);
-					if (_save->getTile(test))
+					if (player && !reuse)
 					{
-						BattleUnit *visibleUnit = _save->getTile(test)->getUnit();
-						if (visibleUnit && !visibleUnit->isOut() && visible(unit, _save->getTile(test)))
+						view->cells.push_back(0);
+					}
+					Tile *tile = _save->getTile(test);
+					if (tile)
+					{
+						BattleUnit *visibleUnit = tile->getUnit();
+						if (visibleUnit && !visibleUnit->isOut() && visible(unit, tile))
 						{
-							if ((visibleUnit->getFaction() == FACTION_HOSTILE && unit->getFaction() != FACTION_HOSTILE)
-								|| (visibleUnit->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE))
-							{
-								unit->addToVisibleUnits(visibleUnit);
-								unit->addToVisibleTiles(visibleUnit->getTile());
-								visibleUnit->getTile()->setDiscovered(true, 2);
-								visibleUnit->getTile()->setVisible(+1);
-							}
-							if (unit->getFaction() == FACTION_PLAYER)
-							{
-								visibleUnit->setVisible(true);
-							}
-							else if (unit->getFaction() == FACTION_HOSTILE && visibleUnit->getFaction() == FACTION_PLAYER && unit->getIntelligence() > visibleUnit->getTurnsExposed())
-							{
-								visibleUnit->setTurnsExposed(unit->getIntelligence());
-								_save->updateExposedUnits();
-							}
+							view->spotted.push_back(visibleUnit);
 						}
 
-						if (unit->getFaction() == FACTION_PLAYER)
+						if (player)
 						{
 							// this sets tiles to discovered if they are in LOS - tile visibility is not calculated in voxelspace but in tilespace
 							// large units have "4 pair of eyes"
-							int size = unit->getArmor()->getSize();
+							Uint8 &eyes = view->cells[cell];
 							for (int xo = 0; xo < size; xo++)
 							{
 								for (int yo = 0; yo < size; yo++)
 								{
 									Position poso = pos + Position(xo,yo,0);
-									if (calculateLine(poso, test, false, 0, unit, false) <= 0)
+									Uint8 bit = 1 << (xo * size + yo);
+									if (!reuse || (!dirty.empty() && crossesDirtyTile(poso, test, dirty)))
+									{
+										if (calculateLine(poso, test, false, 0, unit, false) <= 0)
+											eyes |= bit;
+										else
+											eyes &= ~bit;
+									}
+									if (eyes & bit)
 									{
-										unit->addToVisibleTiles(_save->getTile(test));
-										_save->getTile(test)->setDiscovered(true, 2);
-										_save->getTile(test)->setVisible(+1);
-										// walls to the east or south of a visible tile, we see that too
-										Tile* t = _save->getTile(Position(test.x + 1, test.y, test.z));
-										if (t) t->setDiscovered(true, 0);
-										t = _save->getTile(Position(test.x, test.y + 1, test.z));
-										if (t) t->setDiscovered(true, 1);
+										view->tiles.push_back(tile);
 									}
 								}
 							}
 						}
 					}
+					++cell;
 				}
 			}
 		}
 	}
+}
+
+/**
+ * Applies what a unit sees to the unit and the battlescape: visible units and tiles, fog of war and exposure.
+ * @param unit The unit looking around.
+ * @param view The view of the unit, as worked out by computeFOV().
+ * @return true when new aliens spotted
+ */
+bool TileEngine::applyFOV(BattleUnit *unit, ViewCache *view)
+{
+	size_t visibleUnitsChecksum = 0, oldNumVisibleUnits = 0;
+
+	// calculate a visible units checksum - if it changed during this step, the soldier stops walking
+	// the unit's Xposition * 100 + y seems a simple but unique ID for each unit
+	for (std::vector<BattleUnit*>::iterator i = unit->getVisibleUnits()->begin(); i != unit->getVisibleUnits()->end(); ++i)
+		visibleUnitsChecksum += (*i)->getPosition().x*100 + (*i)->getPosition().y;
+
+	oldNumVisibleUnits = unit->getVisibleUnits()->size();
+
+	unit->clearVisibleUnits();
+	unit->clearVisibleTiles();
+
+	if (unit->isOut())
+		return false;
+
+	for (std::vector<BattleUnit*>::iterator i = view->spotted.begin(); i != view->spotted.end(); ++i)
+	{
+		BattleUnit *visibleUnit = *i;
+		if ((visibleUnit->getFaction() == FACTION_HOSTILE && unit->getFaction() != FACTION_HOSTILE)
+			|| (visibleUnit->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE))
+		{
+			unit->addToVisibleUnits(visibleUnit);
+			unit->addToVisibleTiles(visibleUnit->getTile());
+			visibleUnit->getTile()->setDiscovered(true, 2);
+			visibleUnit->getTile()->setVisible(+1);
+		}
+		if (unit->getFaction() == FACTION_PLAYER)
+		{
+			visibleUnit->setVisible(true);
+		}
+		else if (unit->getFaction() == FACTION_HOSTILE && visibleUnit->getFaction() == FACTION_PLAYER && unit->getIntelligence() > visibleUnit->getTurnsExposed())
+		{
+			visibleUnit->setTurnsExposed(unit->getIntelligence());
+			_save->updateExposedUnits();
+		}
+	}
+
+	for (std::vector<Tile*>::iterator i = view->tiles.begin(); i != view->tiles.end(); ++i)
+	{
+		Position test = (*i)->getPosition();
+		unit->addToVisibleTiles(*i);
+		(*i)->setDiscovered(true, 2);
+		(*i)->setVisible(+1);
+		// walls to the east or south of a visible tile, we see that too
+		Tile* t = _save->getTile(Position(test.x + 1, test.y, test.z));
+		if (t) t->setDiscovered(true, 0);
+		t = _save->getTile(Position(test.x, test.y + 1, test.z));
+		if (t) t->setDiscovered(true, 1);
+	}
 
 	size_t newChecksum = 0;
 	for (std::vector<BattleUnit*>::iterator i = unit->getVisibleUnits()->begin(); i != unit->getVisibleUnits()->end(); ++i)
@@ -345,6 +709,44 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 
 }
 
+/**
+ * Collects the tiles whose terrain changed since the last call (destroyed parts, opened or closed doors)
+ * from the battle's log of terrain changes. These make the cached lines of sight passing near them invalid.
+ * When too many tiles changed at once, all cached lines of sight are dropped instead.
+ */
+void TileEngine::updateDirtyTiles()
+{
+	if (!_save->getTerrainChanges(&_viewTerrainChanges, &_dirtyTiles) || _dirtyTiles.size() > MAX_DIRTY_TILES)
+	{
+		_dirtyTiles.clear();
+		_viewCache.clear();
+	}
+}
+
+/**
+ * Checks if a line of sight in tilespace can be affected by any of the changed tiles.
+ * This is a conservative test: the changed tile has to be within the box spanned by the line,
+ * grown by one tile because diagonal steps also check the neighbouring tiles.
+ * @param origin The tile the line starts at.
+ * @param target The tile the line ends at.
+ * @param dirty The changed tiles.
+ * @return true when the line has to be traced again.
+ */
+bool TileEngine::crossesDirtyTile(const Position &origin, const Position &target, const std::vector<Position> &dirty) const
+{
+	int minX = std::min(origin.x, target.x) - 1, maxX = std::max(origin.x, target.x) + 1;
+	int minY = std::min(origin.y, target.y) - 1, maxY = std::max(origin.y, target.y) + 1;
+	int minZ = std::min(origin.z, target.z) - 1, maxZ = std::max(origin.z, target.z) + 1;
+	for (std::vector<Position>::const_iterator i = dirty.begin(); i != dirty.end(); ++i)
+	{
+		if (i->x >= minX && i->x <= maxX && i->y >= minY && i->y <= maxY && i->z >= minZ && i->z <= maxZ)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 
 /**
  * Check for an opposing unit on this tile
@@ -446,13 +848,15 @@ bool TileEngine::visible(BattleUnit *currentUnit, Tile *tile)
  */
 void TileEngine::calculateFOV(const Position &position)
 {
+	std::vector<BattleUnit*> units;
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		if (distance(position, (*i)->getPosition()) < 20 && (*i)->getFaction() == _save->getSide())
 		{
-			calculateFOV(*i);
+			units.push_back(*i);
 		}
 	}
+	calculateFOV(units);
 }
 
 /**
@@ -474,7 +878,7 @@ bool TileEngine::checkReactionFire(BattleUnit *unit, BattleAction *action, Battl
 		return false;
 	}
 
-	if (potentialVictim && RNG::generate(0, 4) == 1 && potentialVictim->getFaction() == FACTION_HOSTILE)
+	if (potentialVictim && RNG::generate(RNG::BATTLESCAPE, 0, 4) == 1 && potentialVictim->getFaction() == FACTION_HOSTILE)
 	{
 		potentialVictim->lookAt(unit->getPosition());
 		while (potentialVictim->getStatus() == STATUS_TURNING)
@@ -499,22 +903,27 @@ bool TileEngine::checkReactionFire(BattleUnit *unit, BattleAction *action, Battl
 	// we reset the unit to false here - if it is seen by any unit in range below the unit becomes visible again
 	//unit->setVisible(false);
 
+	std::vector<BattleUnit*> spotters;
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		if (distance(unit->getPosition(), (*i)->getPosition()) < 19 && (*i)->getFaction() != _save->getSide() && !(*i)->isOut())
 		{
-			if (recalculateFOV)
-			{
-				calculateFOV(*i);
-			}
-			for (std::vector<BattleUnit*>::iterator j = (*i)->getVisibleUnits()->begin(); j != (*i)->getVisibleUnits()->end(); ++j)
+			spotters.push_back(*i);
+		}
+	}
+	if (recalculateFOV)
+	{
+		calculateFOV(spotters);
+	}
+	for (std::vector<BattleUnit*>::iterator i = spotters.begin(); i != spotters.end(); ++i)
+	{
+		for (std::vector<BattleUnit*>::iterator j = (*i)->getVisibleUnits()->begin(); j != (*i)->getVisibleUnits()->end(); ++j)
+		{
+			if ((*j) == unit && (*i)->getReactionScore() > highestReactionScore && (*i)->getMainHandWeapon())
 			{
-				if ((*j) == unit && (*i)->getReactionScore() > highestReactionScore && (*i)->getMainHandWeapon())
-				{
-					// I see you!
-					highestReactionScore = (*i)->getReactionScore();
-					action->actor = (*i);
-				}
+				// I see you!
+				highestReactionScore = (*i)->getReactionScore();
+				action->actor = (*i);
 			}
 		}
 	}
@@ -568,14 +977,14 @@ BattleUnit *TileEngine::hit(const Position &center, int power, ItemDamageType ty
 	if (part >= 0 && part <= 3)
 	{
 		// power 25% to 75%
-		int rndPower = RNG::generate(power/4, (power*3)/4); //RNG::boxMuller(power, power/6)
+		int rndPower = RNG::generate(RNG::BATTLESCAPE, power/4, (power*3)/4); //RNG::boxMuller(RNG::BATTLESCAPE, power, power/6)
 		if (tile->damage(part, rndPower))
 			_save->setObjectiveDestroyed(true);
 	}
 	else if (part == 4)
 	{
 		// power 0 - 200%
-		int rndPower = RNG::generate(0, power*2); // RNG::boxMuller(power, power/3)
+		int rndPower = RNG::generate(RNG::BATTLESCAPE, 0, power*2); // RNG::boxMuller(RNG::BATTLESCAPE, power, power/3)
 		if (bu)
 		{
 			bu->damage(Position(center.x%16, center.y%16, center.z%24 + tile->getTerrainLevel()), rndPower, type);
@@ -598,7 +1007,7 @@ BattleUnit *TileEngine::hit(const Position &center, int power, ItemDamageType ty
 		// conventional weapons can cause additional stun damage
 		if (type == DT_AP && bu)
 		{
-			bu->damage(Position(center.x%16, center.y%16, center.z%24), RNG::generate(0, rndPower/4), DT_STUN, true);
+			bu->damage(Position(center.x%16, center.y%16, center.z%24), RNG::generate(RNG::BATTLESCAPE, 0, rndPower/4), DT_STUN, true);
 		}
 
 		if (bu && bu->getFaction() != unit->getFaction() && type != DT_NONE)
@@ -607,9 +1016,9 @@ BattleUnit *TileEngine::hit(const Position &center, int power, ItemDamageType ty
 		}
 	}
 	applyItemGravity(tile);
-	calculateSunShading(); // roofs could have been destroyed
+	calculateSunShading(tile->getPosition().x, tile->getPosition().y); // roofs could have been destroyed
 	calculateFOV(center);
-	calculateTerrainLighting(); // fires could have been started
+	calculateTerrainLighting(std::vector<Tile*>(1, tile)); // lights could have been destroyed
 	return bu;
 }
 
@@ -629,120 +1038,121 @@ void TileEngine::explode(const Position &center, int power, ItemDamageType type,
 	double centerX = (int)(center.x / 16) + 0.5;
 	double centerY = (int)(center.y / 16) + 0.5;
 	int power_;
-	std::set<Tile*> tilesAffected;
-	std::pair<std::set<Tile*>::iterator,bool> ret;
+	std::vector<Tile*> tilesAffected;
 
 	if (type == DT_IN)
 	{
 		power /= 2;
 	}
 
-	for (int fi = -90; fi <= 90; fi += 10)
+	// a new generation marks all tiles as not visited yet
+	_explosionGeneration++;
+	Tile *centerTile = _save->getTile(center);
+	for (std::vector<ExplosionRay>::const_iterator ray = _explosionRays.begin(); ray != _explosionRays.end(); ++ray)
 	{
-		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
-		for (int te = 0; te <= 360; te += 3)
-		{
-			double cos_te = cos(te * M_PI / 180.0);
-			double sin_te = sin(te * M_PI / 180.0);
-			double sin_fi = sin(fi * M_PI / 180.0);
-
-			Tile *origin = _save->getTile(center);
-			double l = 0;
-			double vx, vy, vz;
-			int tileX, tileY, tileZ;
-			power_ = power + 1;
+		Tile *origin = centerTile;
+		double l = 0;
+		double vx, vy, vz;
+		int tileX, tileY, tileZ;
+		power_ = power + 1;
 
-			while (power_ > 0 && l <= maxRadius)
-			{
-				vx = centerX + l * cos_te;
-				vy = centerY + l * sin_te;
-				vz = centerZ + (l / 2.0) * sin_fi;
+		while (power_ > 0 && l <= maxRadius)
+		{
+			vx = centerX + l * ray->cosTe;
+			vy = centerY + l * ray->sinTe;
+			vz = centerZ + (l / 2.0) * ray->sinFi;
 
-				tileZ = int(floor(vz));
-				tileX = int(floor(vx));
-				tileY = int(floor(vy));
+			tileZ = int(floor(vz));
+			tileX = int(floor(vx));
+			tileY = int(floor(vy));
 
-				Tile *dest = _save->getTile(Position(tileX, tileY, tileZ));
-				if (!dest) break; // out of map!
+			Tile *dest = _save->getTile(Position(tileX, tileY, tileZ));
+			if (!dest) break; // out of map!
 
-				// horizontal blockage by walls
+			// horizontal blockage by walls, nothing blocks when staying on the same tile
+			if (dest != origin)
+			{
 				power_ -= (horizontalBlockage(origin, dest, type) + verticalBlockage(origin, dest, type));
+			}
 
-				if (power_ > 0)
+			if (power_ > 0)
+			{
+				if (type == DT_HE)
 				{
-					if (type == DT_HE)
-					{
-						// explosives do 1/2 damage to terrain and 1/2 up to 3/2 random damage to units
-						dest->setExplosive(power_ / 2);
-					}
+					// explosives do 1/2 damage to terrain and 1/2 up to 3/2 random damage to units
+					dest->setExplosive(power_ / 2);
+				}
 
-					ret = tilesAffected.insert(dest); // check if we had this tile already
-					if (ret.second)
+				// check if we had this tile already
+				int index = _save->getTileIndex(dest->getPosition());
+				if (_explosionVisited[index] != _explosionGeneration)
+				{
+					_explosionVisited[index] = _explosionGeneration;
+					tilesAffected.push_back(dest);
+					if (type == DT_HE || type == DT_STUN)
 					{
-						if (type == DT_HE || type == DT_STUN)
+						// power 50 - 150%
+						if (dest->getUnit())
 						{
-							// power 50 - 150%
-							if (dest->getUnit())
-							{
-								dest->getUnit()->damage(Position(0, 0, 0), (int)(RNG::generate(power_/2.0, power_*1.5)), type);
-							}
-							bool done = false;
-							while (!done)
+							dest->getUnit()->damage(Position(0, 0, 0), (int)(RNG::generate(RNG::BATTLESCAPE, power_/2.0, power_*1.5)), type);
+						}
+						bool done = false;
+						while (!done)
+						{
+							done = dest->getInventory()->size() == 0;
+							for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); )
 							{
-								done = dest->getInventory()->size() == 0;
-								for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); )
+								if (power_ > (*it)->getRules()->getArmor())
 								{
-									if (power_ > (*it)->getRules()->getArmor())
-									{
-										_save->removeItem((*it));
-										break;
-									}
-									else
-									{
-										++it;
-										done = it == dest->getInventory()->end();
-									}
+									_save->removeItem((*it));
+									break;
+								}
+								else
+								{
+									++it;
+									done = it == dest->getInventory()->end();
 								}
 							}
 						}
-						if (type == DT_SMOKE)
+					}
+					if (type == DT_SMOKE)
+					{
+						// smoke from explosions always stay 6 to 14 turns - power of a smoke grenade is 60
+						if (dest->getSmoke() < 10)
 						{
-							// smoke from explosions always stay 6 to 14 turns - power of a smoke grenade is 60
-							if (dest->getSmoke() < 10)
-							{
-								dest->addSmoke(RNG::generate(power_/10, 14));
-							}
+							dest->addSmoke(RNG::generate(RNG::BATTLESCAPE, power_/10, 14));
 						}
-						if (type == DT_IN && !dest->isVoid())
+					}
+					if (type == DT_IN && !dest->isVoid())
+					{
+						if (dest->getFire() == 0)
 						{
-							if (dest->getFire() == 0)
-							{
-								dest->ignite();
-							}
-							if (dest->getUnit())
-							{
-								dest->getUnit()->damage(Position(0, 0, 0), RNG::generate(0, power_/3), type); // immediate IN damage
-								dest->getUnit()->setFire(RNG::generate(1, 5)); // catch fire and burn for 1-5 rounds
-							}
+							dest->ignite();
 						}
-
-						if (unit && dest->getUnit() && dest->getUnit()->getFaction() != unit->getFaction())
+						if (dest->getUnit())
 						{
-							unit->addFiringExp();
+							dest->getUnit()->damage(Position(0, 0, 0), RNG::generate(RNG::BATTLESCAPE, 0, power_/3), type); // immediate IN damage
+							dest->getUnit()->setFire(RNG::generate(RNG::BATTLESCAPE, 1, 5)); // catch fire and burn for 1-5 rounds
 						}
+					}
 
+					if (unit && dest->getUnit() && dest->getUnit()->getFaction() != unit->getFaction())
+					{
+						unit->addFiringExp();
 					}
+
 				}
-				power_ -= 10; // explosive damage decreases by 10
-				origin = dest;
-				l++;
 			}
+			power_ -= 10; // explosive damage decreases by 10
+			origin = dest;
+			l++;
 		}
 	}
-	// now detonate the tiles affected with HE
+	// now detonate the tiles affected with HE, in the same order as always
+	std::sort(tilesAffected.begin(), tilesAffected.end());
 	if (type == DT_HE)
 	{
-		for (std::set<Tile*>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+		for (std::vector<Tile*>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
 		{
 			if ((*i)->detonate())
 				_save->setObjectiveDestroyed(true);
@@ -750,9 +1160,26 @@ void TileEngine::explode(const Position &center, int power, ItemDamageType type,
 		}
 	}
 
-	calculateSunShading(); // roofs could have been destroyed
+	// fires and smoke could have been started
+	for (std::vector<Tile*>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+	{
+		_save->trackFireAndSmoke(*i);
+	}
+
+	// roofs could have been destroyed
+	std::vector<int> columns;
+	for (std::vector<Tile*>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+	{
+		columns.push_back((*i)->getPosition().y * _save->getWidth() + (*i)->getPosition().x);
+	}
+	std::sort(columns.begin(), columns.end());
+	columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+	for (std::vector<int>::iterator i = columns.begin(); i != columns.end(); ++i)
+	{
+		calculateSunShading(*i % _save->getWidth(), *i / _save->getWidth());
+	}
 	calculateFOV(center);
-	calculateTerrainLighting(); // fires could have been started
+	calculateTerrainLighting(tilesAffected); // fires could have been started
 }
 
 /**
@@ -1289,13 +1716,18 @@ int TileEngine::calculateParabola(const Position& origin, const Position& target
  */
 int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool excludeAllUnits)
 {
-
-	Tile *tile = _save->getTile(Position(voxel.x/16, voxel.y/16, voxel.z/24));
 	// check if we are not out of the map
-	if (tile == 0 || voxel.x < 0 || voxel.y < 0 || voxel.z < 0)
+	if (voxel.x < 0 || voxel.y < 0 || voxel.z < 0)
 	{
 		return 5;
 	}
+	Position pos(voxel.x / 16, voxel.y / 16, voxel.z / 24);
+	if (pos.x >= _save->getWidth() || pos.y >= _save->getLength() || pos.z >= _save->getHeight())
+	{
+		return 5;
+	}
+	int index = _save->getTileIndex(pos);
+	Tile *tile = _save->getTiles()[index];
 
 	if (!excludeAllUnits)
 	{
@@ -1307,16 +1739,16 @@ int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool
 				int x = voxel.x%16;
 				int y = voxel.y%16;
 				int idx = (unit->getLoftemps() * 16) + y;
-				if ((_voxelData->at(idx) & (1 << x))==(1 << x))
+				if (((*_voxelData)[idx] & (1 << x))==(1 << x))
 				{
 					return 4;
 				}
 			}
 		}
 		// sometimes there is unit on the tile below, but sticks up to this tile with his head
-		Tile *below = _save->getTile(Position(voxel.x/16, voxel.y/16, (voxel.z/24)-1));
-		if (below)
+		if (pos.z > 0)
 		{
+			Tile *below = _save->getTiles()[index - _save->getWidth() * _save->getLength()];
 			BattleUnit *unit = below->getUnit();
 			if (unit != 0 && unit != excludeUnit)
 			{
@@ -1325,7 +1757,7 @@ int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool
 					int x = voxel.x%16;
 					int y = voxel.y%16;
 					int idx = (unit->getLoftemps() * 16) + y;
-					if ((_voxelData->at(idx) & (1 << x))==(1 << x))
+					if (((*_voxelData)[idx] & (1 << x))==(1 << x))
 					{
 						return 4;
 					}
@@ -1334,6 +1766,21 @@ int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool
 		}
 	}
 
+	// the cached terrain voxels of all parts together tell us if anything is hit at all
+	const Uint16 *terrain = getTerrainVoxels(index, tile);
+	if (terrain == 0)
+	{
+		return -1;
+	}
+	int x = 15 - voxel.x%16;
+	int y = voxel.y%16;
+	int layer = (voxel.z%24)/2;
+	if ((terrain[layer * 16 + y] & (1 << x)) == 0)
+	{
+		return -1;
+	}
+
+	// something is hit, find out which part it was
 	for (int i=0; i< 4; ++i)
 	{
 		MapData *mp = tile->getMapData(i);
@@ -1341,10 +1788,8 @@ int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool
 			continue;
 		if (mp != 0)
 		{
-			int x = 15 - voxel.x%16;
-			int y = voxel.y%16;
-			int idx = (mp->getLoftID((voxel.z%24)/2)*16) + y;
-			if ((_voxelData->at(idx) & (1 << x))==(1 << x))
+			int idx = (mp->getLoftID(layer)*16) + y;
+			if (((*_voxelData)[idx] & (1 << x))==(1 << x))
 			{
 				return i;
 			}
@@ -1353,6 +1798,64 @@ int TileEngine::voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool
 	return -1;
 }
 
+/**
+ * Gets the combined terrain voxels of all parts of a tile: LOFT_LAYERS layers of 16 rows of 16 bits,
+ * laid out the same way as the LOFTEMPS data. The cache entry is rebuilt whenever the
+ * terrain version of the tile changes (parts destroyed, doors opened or closed).
+ * @param index The index of the tile.
+ * @param tile The tile.
+ * @return pointer to the voxel rows, or 0 when the tile has no terrain at all.
+ */
+const Uint16 *TileEngine::getTerrainVoxels(int index, Tile *tile)
+{
+	if (_terrainVoxelVersion[index] != tile->getTerrainVersion())
+	{
+		_terrainVoxelVersion[index] = tile->getTerrainVersion();
+
+		bool empty = true;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (tile->getMapData(i) && !tile->isUfoDoorOpen(i))
+			{
+				empty = false;
+				break;
+			}
+		}
+		if (empty && _terrainVoxelSlot[index] == -1)
+		{
+			return 0;
+		}
+		if (_terrainVoxelSlot[index] == -1)
+		{
+			_terrainVoxelSlot[index] = _terrainVoxels.size();
+			_terrainVoxels.resize(_terrainVoxels.size() + LOFT_LAYERS * 16);
+		}
+
+		Uint16 *terrain = &_terrainVoxels[_terrainVoxelSlot[index]];
+		std::fill(terrain, terrain + LOFT_LAYERS * 16, 0);
+		for (int i = 0; i < 4; ++i)
+		{
+			MapData *mp = tile->getMapData(i);
+			if (mp == 0 || tile->isUfoDoorOpen(i))
+				continue;
+			for (int layer = 0; layer < LOFT_LAYERS; ++layer)
+			{
+				int idx = mp->getLoftID(layer) * 16;
+				for (int y = 0; y < 16; ++y)
+				{
+					terrain[layer * 16 + y] |= _voxelData->at(idx + y);
+				}
+			}
+		}
+	}
+
+	if (_terrainVoxelSlot[index] == -1)
+	{
+		return 0;
+	}
+	return &_terrainVoxels[_terrainVoxelSlot[index]];
+}
+
 
 
 /**
@@ -1388,7 +1891,7 @@ bool TileEngine::psiAttack(BattleAction *action)
 	double defenseStrength = victim->getStats()->psiStrength + 30 + (victim->getStats()->psiSkill / 5);
 	int d = distance(action->actor->getPosition(), action->target);
 	attackStrength -= d/2;
-	attackStrength += RNG::generate(0,55);
+	attackStrength += RNG::generate(RNG::BATTLESCAPE, 0,55);
 	if (action->type == BA_PANIC)
 	{
 		if (attackStrength > defenseStrength)
@@ -20,6 +20,7 @@
 #define OPENXCOM_TILEENGINE_H
 
 #include <vector>
+#include <map>
 #include "Position.h"
 #include "../Ruleset/MapData.h"
 #include <SDL.h>
@@ -30,6 +31,7 @@ namespace OpenXcom
 {
 
 class SavedBattleGame;
+class ThreadPool;
 class BattleUnit;
 class BattleItem;
 class Tile;
@@ -41,14 +43,65 @@ class Tile;
 class TileEngine
 {
 private:
+	/**
+	 * What a unit saw at the last field of view calculation.
+	 * For player units it also holds the terrain visibility of every tile of the view cone, a bit per pair of eyes that can see the tile.
+	 */
+	struct ViewCache
+	{
+		Position position, eyes;
+		int direction, size;
+		size_t dirtyTiles;
+		std::vector<Uint8> cells;
+		std::vector<BattleUnit*> spotted;
+		std::vector<Tile*> tiles;
+	};
+	/**
+	 * A light source of the static or dynamic lighting layer.
+	 * Light spreads the same on every level, so only the column matters.
+	 */
+	struct LightSource
+	{
+		int x, y, power;
+		bool operator<(const LightSource &other) const;
+	};
+	/// Direction of one of the rays cast by an explosion.
+	struct ExplosionRay
+	{
+		double cosTe, sinTe, sinFi;
+	};
+	class ViewJob;
 	static const int MAX_VIEW_DISTANCE = 20;
 	static const int MAX_DARKNESS_TO_SEE_UNITS = 9;
+	static const int LOFT_LAYERS = 12;
+	static const size_t MAX_DIRTY_TILES = 1024;
 	SavedBattleGame *_save;
 	std::vector<Uint16> *_voxelData;
-	void addLight(const Position &center, int power, int layer);
+	std::vector<Uint16> _terrainVoxels;
+	std::vector<int> _terrainVoxelSlot, _terrainVoxelVersion;
+	int _viewTerrainChanges;
+	std::vector<Position> _dirtyTiles;
+	std::map<BattleUnit*, ViewCache> _viewCache;
+	std::vector<LightSource> _terrainLights, _unitLights;
+	std::vector<int> _lightFalloff;
+	int _lightFalloffRange;
+	std::vector<bool> _lightDirty;
+	std::vector<ExplosionRay> _explosionRays;
+	std::vector<int> _explosionVisited;
+	int _explosionGeneration;
+	ThreadPool *_threadPool;
+	void computeFOV(BattleUnit *unit, ViewCache *view, bool turret);
+	bool applyFOV(BattleUnit *unit, ViewCache *view);
+	void updateDirtyTiles();
+	bool crossesDirtyTile(const Position &origin, const Position &target, const std::vector<Position> &dirty) const;
+	void calculateSunShading(int x, int y);
+	void addTerrainLights(Tile *tile, std::vector<LightSource> *lights) const;
+	void updateLighting(std::vector<LightSource> *lights, std::vector<LightSource> &newLights, int layer);
+	void addLight(const LightSource &light, int layer, int minX, int maxX, int minY, int maxY);
 	int blockage(Tile *tile, const int part, ItemDamageType type);
 	int vectorToDirection(const Position &vector);
 	int voxelCheck(const Position& voxel, BattleUnit *excludeUnit, bool excludeAllUnits = false);
+	const Uint16 *getTerrainVoxels(int index, Tile *tile);
 	bool _personalLighting;
 public:
 	/// Creates a new TileEngine class.
@@ -61,12 +114,16 @@ public:
 	void calculateSunShading(Tile *tile);
 	/// Calculate the field of view from a units view point.
 	bool calculateFOV(BattleUnit *unit);
+	/// Calculate the field of view of several units.
+	void calculateFOV(const std::vector<BattleUnit*> &units);
 	/// Calculate the field of view within range of a certain position.
 	void calculateFOV(const Position &position);
 	/// Check reaction fire.
 	bool checkReactionFire(BattleUnit *unit, BattleAction *action, BattleUnit *potentialVictim = 0, bool recalculateFOV = true);
 	/// Recalculate lighting of the battlescape.
 	void calculateTerrainLighting();
+	/// Recalculate lighting around some tiles of the battlescape.
+	void calculateTerrainLighting(const std::vector<Tile*> &tiles);
 	/// Recalculate lighting of the battlescape.
 	void calculateUnitLighting();
 	/// Explosions.
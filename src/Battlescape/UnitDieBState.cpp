@@ -67,11 +67,11 @@ UnitDieBState::UnitDieBState(BattlescapeGame *parent, BattleUnit *unit, ItemDama
 	{
 		if ((_unit->getType() == "SOLDIER" && _unit->getGender() == GENDER_MALE) || _unit->getType() == "MALE_CIVILIAN")
 		{
-			_parent->getResourcePack()->getSoundSet("BATTLE.CAT")->getSound(RNG::generate(41,43))->play();
+			_parent->getResourcePack()->getSoundSet("BATTLE.CAT")->getSound(RNG::generate(RNG::BATTLESCAPE, 41,43))->play();
 		}
 		else if ((_unit->getType() == "SOLDIER" && _unit->getGender() == GENDER_FEMALE) || _unit->getType() == "FEMALE_CIVILIAN")
 		{
-			_parent->getResourcePack()->getSoundSet("BATTLE.CAT")->getSound(RNG::generate(44,46))->play();
+			_parent->getResourcePack()->getSoundSet("BATTLE.CAT")->getSound(RNG::generate(RNG::BATTLESCAPE, 44,46))->play();
 		}
 		else
 		{
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BackgroundWriter.h"
+#include <fstream>
+#include "CrossPlatform.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Copies the data and starts the writer thread.
+ * If the thread can't be created, the data is written right away.
+ * @param filename Full path of the file to write.
+ * @param data Pointer to the data.
+ * @param size Size of the data in bytes.
+ */
+BackgroundWriter::BackgroundWriter(const std::string &filename, const char *data, size_t size) : _filename(filename), _data(data, size), _error(""), _thread(0), _done(false), _success(false)
+{
+	_mutex = SDL_CreateMutex();
+	_thread = SDL_CreateThread(writerThread, this);
+	if (_thread == 0)
+	{
+		Log(LOG_WARNING) << "Couldn't create writer thread: " << SDL_GetError();
+		write();
+	}
+}
+
+/**
+ * Waits for the writer thread to finish.
+ */
+BackgroundWriter::~BackgroundWriter()
+{
+	wait();
+	SDL_DestroyMutex(_mutex);
+}
+
+/**
+ * Runs the write on the writer thread.
+ * @param writer Pointer to the writer.
+ * @return Always 0.
+ */
+int BackgroundWriter::writerThread(void *writer)
+{
+	((BackgroundWriter*)writer)->write();
+	return 0;
+}
+
+/**
+ * Writes the data to a temporary file next to the target,
+ * then moves it over the target.
+ */
+void BackgroundWriter::write()
+{
+	std::string temp = _filename + ".tmp";
+	std::string error;
+	{
+		std::ofstream file(temp.c_str(), std::ios::out | std::ios::binary);
+		if (file)
+		{
+			file.write(_data.data(), _data.size());
+			file.close();
+		}
+		if (!file)
+		{
+			error = "Failed to save " + _filename;
+		}
+	}
+	if (error.empty() && !CrossPlatform::moveFile(temp, _filename))
+	{
+		error = "Failed to replace " + _filename;
+	}
+	if (!error.empty())
+	{
+		CrossPlatform::deleteFile(temp);
+	}
+	std::string().swap(_data);
+
+	SDL_mutexP(_mutex);
+	_error = error;
+	_success = error.empty();
+	_done = true;
+	SDL_mutexV(_mutex);
+}
+
+/**
+ * Checks if the write has finished, without waiting.
+ * @return True if the file was written or the write failed.
+ */
+bool BackgroundWriter::isDone()
+{
+	SDL_mutexP(_mutex);
+	bool done = _done;
+	SDL_mutexV(_mutex);
+	return done;
+}
+
+/**
+ * Waits for the write to finish.
+ * @return True if the file was written successfully.
+ */
+bool BackgroundWriter::wait()
+{
+	if (_thread != 0)
+	{
+		SDL_WaitThread(_thread, 0);
+		_thread = 0;
+	}
+	return _success;
+}
+
+/**
+ * Gets the reason a write failed. Only valid once the write is done.
+ * @return Error message, empty if there was no error.
+ */
+const std::string &BackgroundWriter::getError() const
+{
+	return _error;
+}
+
+}
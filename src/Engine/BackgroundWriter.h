@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_BACKGROUNDWRITER_H
+#define OPENXCOM_BACKGROUNDWRITER_H
+
+#include <string>
+#include <SDL.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Writes a block of data to a file on a separate thread.
+ * The data goes to a temporary file first, which then replaces
+ * the target, so an interrupted write never leaves a broken file.
+ */
+class BackgroundWriter
+{
+private:
+	std::string _filename, _data, _error;
+	SDL_Thread *_thread;
+	SDL_mutex *_mutex;
+	bool _done, _success;
+	/// Writes the data and renames the file.
+	void write();
+	/// Entry point of the writer thread.
+	static int writerThread(void *writer);
+public:
+	/// Starts writing data to a file.
+	BackgroundWriter(const std::string &filename, const char *data, size_t size);
+	/// Waits for the write to finish and cleans up.
+	~BackgroundWriter();
+	/// Checks if the write has finished.
+	bool isDone();
+	/// Waits for the write to finish.
+	bool wait();
+	/// Gets the reason a write failed.
+	const std::string &getError() const;
+};
+
+}
+
+#endif
@@ -28,6 +28,8 @@
 #include <shlobj.h>
 #include <shlwapi.h>
 #include <direct.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #ifndef SHGFP_TYPE_CURRENT
 #define SHGFP_TYPE_CURRENT 0
 #endif
@@ -42,6 +44,7 @@
 #include <stdlib.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <pwd.h>
 #endif
 
@@ -472,5 +475,65 @@ bool deleteFile(const std::string &path)
 #endif
 }
 
+/**
+ * Moves a file to a new path, replacing any file already there.
+ * @param src Path of the file to move.
+ * @param dest Path to move it to.
+ * @return True if the file was moved.
+ */
+bool moveFile(const std::string &src, const std::string &dest)
+{
+#ifdef _WIN32
+	int size = MultiByteToWideChar(CP_UTF8, 0, &src[0], (int)src.size(), NULL, 0);
+	std::wstring wsrc(size, 0);
+	MultiByteToWideChar(CP_UTF8, 0, &src[0], (int)src.size(), &wsrc[0], size);
+	size = MultiByteToWideChar(CP_UTF8, 0, &dest[0], (int)dest.size(), NULL, 0);
+	std::wstring wdest(size, 0);
+	MultiByteToWideChar(CP_UTF8, 0, &dest[0], (int)dest.size(), &wdest[0], size);
+	return (MoveFileExW(wsrc.c_str(), wdest.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+	return (rename(src.c_str(), dest.c_str()) == 0);
+#endif
+}
+
+/**
+ * Gets the last modification time of a file.
+ * @param path Full path to file.
+ * @return Modification time, -1 if the file can't be found.
+ */
+time_t getDateModified(const std::string &path)
+{
+#ifdef _WIN32
+	struct _stat info;
+	if (_stat(path.c_str(), &info) == 0)
+#else
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+#endif
+	{
+		return info.st_mtime;
+	}
+	return -1;
+}
+
+/**
+ * Gets the wall clock time with better than millisecond
+ * resolution, for timing short pieces of code.
+ * @return Time in milliseconds since an arbitrary point.
+ */
+double getWallTime()
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec * 1000.0 + time.tv_usec / 1000.0;
+#endif
+}
+
 }
 }
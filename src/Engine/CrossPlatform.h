@@ -21,6 +21,7 @@
 
 #include <string>
 #include <vector>
+#include <ctime>
 
 namespace OpenXcom
 {
@@ -53,6 +54,12 @@ namespace CrossPlatform
 	bool fileExists(const std::string &path);
 	/// Deletes the specified file.
 	bool deleteFile(const std::string &path);
+	/// Moves a file, replacing the destination.
+	bool moveFile(const std::string &src, const std::string &dest);
+	/// Gets the last modification time of a file.
+	time_t getDateModified(const std::string &path);
+	/// Gets a high resolution wall clock time.
+	double getWallTime();
 }
 
 }
@@ -43,6 +43,9 @@ std::string _configFolder = "";
 std::vector<std::string> _userList;
 std::map<std::string, std::string> _options;
 std::vector<std::string> _rulesets;
+std::string _benchmarkSave = "";
+int _benchmarkMonths = 12;
+std::string _benchmarkPolicy = "return";
 
 /**
  * Creates a default set of options based on the system.
@@ -81,6 +84,7 @@ void createDefault()
 	setBool("fpsCounter", false);
 	setBool("craftLaunchAlways", false);
 	setBool("globeSeasons", false);
+	setInt("globeLandResolution", 4); // land mask cells per degree
 	setInt("audioSampleRate", 22050);
 	setInt("audioBitDepth", 16);
 	setInt("pauseMode", 0);
@@ -88,6 +92,7 @@ void createDefault()
 	setBool("aggressiveRetaliation", false);
 	setBool("strafe", false);
 	setBool("battleNotifyDeath", false);
+	setInt("battleWorkerThreads", 3); // extra threads for battlescape calculations, 0 to disable
 
 	_rulesets.push_back("Xcom1Ruleset");
 }
@@ -126,6 +131,20 @@ void loadArgs(int argc, char** args)
 				{
 					_userFolder = CrossPlatform::endPath(args[i+1]);
 				}
+				else if (argname == "benchmarksave")
+				{
+					_benchmarkSave = args[i+1];
+				}
+				else if (argname == "benchmarkmonths")
+				{
+					std::stringstream ss;
+					ss << std::dec << args[i+1];
+					ss >> std::dec >> _benchmarkMonths;
+				}
+				else if (argname == "benchmarkpolicy")
+				{
+					_benchmarkPolicy = args[i+1];
+				}
 				else
 				{
 					Log(LOG_WARNING) << "Unknown option: " << argname;
@@ -159,6 +178,12 @@ bool showHelp(int argc, char** args)
 	help << "        use PATH as the default User Folder instead of auto-detecting" << std::endl << std::endl;
 	help << "-KEY VALUE" << std::endl;
 	help << "        set option KEY to VALUE instead of default/loaded value (eg. -displayWidth 640)" << std::endl << std::endl;
+	help << "-benchmarkSave NAME" << std::endl;
+	help << "        run the saved game NAME without a display and log timings" << std::endl << std::endl;
+	help << "-benchmarkMonths N" << std::endl;
+	help << "        number of months to run the benchmark for (default 12)" << std::endl << std::endl;
+	help << "-benchmarkPolicy return|patrol" << std::endl;
+	help << "        send craft awaiting orders back to base or leave them patrolling (default return)" << std::endl << std::endl;
 	help << "-help" << std::endl;
 	help << "-?" << std::endl;
 	help << "        show command-line help" << std::endl;
@@ -372,6 +397,36 @@ std::string getUserFolder()
 	return _userFolder;
 }
 
+/**
+ * Returns the saved game to run as a benchmark. Only set
+ * from the command line, so it's never kept in the options file.
+ * @return Save filename without extension, empty if there's no benchmark.
+ */
+std::string getBenchmarkSave()
+{
+	return _benchmarkSave;
+}
+
+/**
+ * Returns the number of months a benchmark runs for.
+ * Only set from the command line.
+ * @return Number of months.
+ */
+int getBenchmarkMonths()
+{
+	return _benchmarkMonths;
+}
+
+/**
+ * Returns how the benchmark answers popups.
+ * Only set from the command line.
+ * @return Policy name, "return" or "patrol".
+ */
+std::string getBenchmarkPolicy()
+{
+	return _benchmarkPolicy;
+}
+
 /**
  * Returns an option in string format.
  * @param id Option ID.
@@ -57,6 +57,12 @@ namespace Options
 	std::vector<std::string> *getDataList();
 	/// Gets the game's user folder.
 	std::string getUserFolder();
+	/// Gets the saved game to benchmark.
+	std::string getBenchmarkSave();
+	/// Gets the number of months to benchmark.
+	int getBenchmarkMonths();
+	/// Gets the popup policy of the benchmark.
+	std::string getBenchmarkPolicy();
 	/// Gets a string option.
 	std::string getString(const std::string& id);
 	/// Gets an integer option.
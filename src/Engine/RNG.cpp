@@ -19,7 +19,6 @@
 #include "RNG.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
-#include <cstdlib>
 #include <ctime>
 
 namespace OpenXcom
@@ -27,46 +26,167 @@ namespace OpenXcom
 namespace RNG
 {
 
-unsigned int _seed = 0;
-long _count = 0;
+Generator _streams[STREAMS];
 
 /**
- * Seeds the random generator with a new number.
+ * Creates a generator with a fixed seed.
+ * @param seed Starting seed.
+ */
+Generator::Generator(Uint32 seed)
+{
+	this->seed(seed);
+}
+
+/**
+ * Restarts the sequence from a seed, spreading it over the whole state.
+ * @param seed New seed.
+ */
+void Generator::seed(Uint32 seed)
+{
+	Uint32 x = seed;
+	for (int i = 0; i < 4; ++i)
+	{
+		x = 1812433253U * (x ^ (x >> 30)) + i + 1;
+		_state[i] = x;
+	}
+	// an all-zero state would only ever generate zeros
+	if (!_state[0] && !_state[1] && !_state[2] && !_state[3])
+		_state[0] = 1;
+}
+
+/**
+ * Generates the next number of the sequence (xorshift128).
+ * @return Number covering all 32 bits.
+ */
+Uint32 Generator::next()
+{
+	Uint32 t = _state[0] ^ (_state[0] << 11);
+	_state[0] = _state[1];
+	_state[1] = _state[2];
+	_state[2] = _state[3];
+	_state[3] = _state[3] ^ (_state[3] >> 19) ^ t ^ (t >> 8);
+	return _state[3];
+}
+
+/**
+ * Generates a random integer number within a certain range.
+ * @param min Minimum number.
+ * @param max Maximum number.
+ * @return Generated number.
+ */
+int Generator::generate(int min, int max)
+{
+	int num = next() >> 1;
+	return (num % (max - min + 1) + min);
+}
+
+/**
+ * Generates a random decimal number within a certain range.
+ * @param min Minimum number.
+ * @param max Maximum number.
+ * @return Generated number.
+ */
+double Generator::generate(double min, double max)
+{
+	int num = next() >> 1;
+	return (num * (max - min) / 0x7FFFFFFF + min);
+}
+
+/**
+ * Normal random variate generator
+ * @param m mean
+ * @param s standard deviation
+ * @return normally distributed value.
+ */
+double Generator::boxMuller(double m, double s)
+{
+	double x1, x2, w;
+	do {
+		x1 = 2.0 * generate(0.0, 1.0) - 1.0;
+		x2 = 2.0 * generate(0.0, 1.0) - 1.0;
+		w = x1 * x1 + x2 * x2;
+	} while ( w >= 1.0 || w == 0.0 );
+
+	w = sqrt( (-2.0 * log( w ) ) / w );
+	return( m + x1 * w * s );
+}
+
+/**
+ * Loads the generator state from a YAML sequence.
+ * @param node YAML node.
+ */
+void Generator::load(const YAML::Node &node)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		node[i] >> _state[i];
+	}
+	if (!_state[0] && !_state[1] && !_state[2] && !_state[3])
+		_state[0] = 1;
+}
+
+/**
+ * Saves the generator state to a YAML sequence.
+ * @param out YAML emitter.
+ */
+void Generator::save(YAML::Emitter &out) const
+{
+	out << YAML::Flow << YAML::BeginSeq;
+	for (int i = 0; i < 4; ++i)
+	{
+		out << _state[i];
+	}
+	out << YAML::EndSeq;
+}
+
+/**
+ * Seeds every stream from a new number.
  * Defaults to the current time if none is set.
  * @param seed New seed.
  */
-void init(long count, unsigned int seed)
+void init(Uint32 seed)
 {
-	_seed = seed;
-	_count = count;
-	if (count == -1)
+	if (seed == 0)
 	{
-		_seed = (unsigned int)time(NULL);
-		_count = 0;
-		srand(_seed);
+		seed = (Uint32)time(NULL);
 	}
-	else
+	for (int i = 0; i < STREAMS; ++i)
 	{
-		srand(_seed);
-		for (long i = 0; i < count; ++i)
-		{
-			rand();
-		}
+		_streams[i].seed(seed + i * 0x9E3779B9U);
 	}
 }
 
+/**
+ * Gets the generator of a stream.
+ * @param stream Stream to use.
+ * @return Reference to the generator.
+ */
+Generator &getStream(Stream stream)
+{
+	return _streams[stream];
+}
+
 /**
  * Loads the RNG from a YAML file.
+ * Older saves only have a seed and a count of numbers drawn,
+ * which are combined into a new seed instead of being replayed.
  * @param node YAML node.
  */
 void load(const YAML::Node &node)
 {
-	int count, seed;
-	if (node.FindValue("rngCount") != 0)
+	if (const YAML::Node *pName = node.FindValue("rng"))
 	{
+		for (unsigned int i = 0; i < pName->size() && i < STREAMS; ++i)
+		{
+			_streams[i].load((*pName)[i]);
+		}
+	}
+	else if (node.FindValue("rngCount") != 0)
+	{
+		unsigned int count, seed;
 		node["rngCount"] >> count;
 		node["rngSeed"] >> seed;
-		init(count, seed);
+		init((seed ^ (count * 2654435761U)) | 1);
 	}
 }
 
@@ -76,8 +196,12 @@ void load(const YAML::Node &node)
  */
 void save(YAML::Emitter &out)
 {
-	out << YAML::Key << "rngCount" << YAML::Value << _count;
-	out << YAML::Key << "rngSeed" << YAML::Value << _seed;
+	out << YAML::Key << "rng" << YAML::Value << YAML::BeginSeq;
+	for (int i = 0; i < STREAMS; ++i)
+	{
+		_streams[i].save(out);
+	}
+	out << YAML::EndSeq;
 }
 
 /**
@@ -88,9 +212,7 @@ void save(YAML::Emitter &out)
  */
 int generate(int min, int max)
 {
-	_count++;
-	int num = rand();
-	return (num % (max - min + 1) + min);
+	return _streams[GEOSCAPE].generate(min, max);
 }
 
 /**
@@ -101,9 +223,7 @@ int generate(int min, int max)
  */
 double generate(double min, double max)
 {
-	_count++;
-	int num = rand();
-	return (num * (max - min) / RAND_MAX + min);
+	return _streams[GEOSCAPE].generate(min, max);
 }
 
 /**
@@ -114,31 +234,43 @@ double generate(double min, double max)
  */
 double boxMuller(double m, double s)
 {
-	double y1;
-	static double y2;
-	static int use_last = 0;
+	return _streams[GEOSCAPE].boxMuller(m, s);
+}
 
-	if (use_last)				/* use value from previous call */
-	{
-		y1 = y2;
-		use_last = 0;
-	}
-	else
-	{
-		double x1, x2, w;
-		do {
-			x1 = 2.0 * generate(0.0, 1.0) - 1.0;
-			x2 = 2.0 * generate(0.0, 1.0) - 1.0;
-			w = x1 * x1 + x2 * x2;
-		} while ( w >= 1.0 );
-
-		w = sqrt( (-2.0 * log( w ) ) / w );
-		y1 = x1 * w;
-		y2 = x2 * w;
-		use_last = 1;
-	}
+/**
+ * Generates a random integer number from a stream within a certain range.
+ * @param stream Stream to use.
+ * @param min Minimum number.
+ * @param max Maximum number.
+ * @return Generated number.
+ */
+int generate(Stream stream, int min, int max)
+{
+	return _streams[stream].generate(min, max);
+}
 
-	return( m + y1 * s );
+/**
+ * Generates a random decimal number from a stream within a certain range.
+ * @param stream Stream to use.
+ * @param min Minimum number.
+ * @param max Maximum number.
+ * @return Generated number.
+ */
+double generate(Stream stream, double min, double max)
+{
+	return _streams[stream].generate(min, max);
+}
+
+/**
+ * Normal random variate generator using a stream.
+ * @param stream Stream to use.
+ * @param m mean
+ * @param s standard deviation
+ * @return normally distributed value.
+ */
+double boxMuller(Stream stream, double m, double s)
+{
+	return _streams[stream].boxMuller(m, s);
 }
 
 }
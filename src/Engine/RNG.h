@@ -19,6 +19,7 @@
 #ifndef OPENXCOM_RNG_H
 #define OPENXCOM_RNG_H
 
+#include <SDL.h>
 #include <yaml-cpp/yaml.h>
 
 namespace OpenXcom
@@ -26,14 +27,48 @@ namespace OpenXcom
 
 /**
  * Random Number Generator used throughout the game
- * for all your randomness needs. It's really just the
- * standard C generator, but wrapped in a way that we
- * can store its seed for later use if necessary.
+ * for all your randomness needs. Each part of the game
+ * draws from its own stream, so they don't disturb each
+ * other's sequences, and the full state of every stream
+ * is stored in the saved game.
  */
 namespace RNG
 {
-	/// Initializes the generator.
-	void init(long count = -1, unsigned int seed = 0);
+	/// Independent streams of numbers.
+	enum Stream { GEOSCAPE, BATTLESCAPE, AI, STREAMS };
+
+	/**
+	 * A xorshift generator with explicit state,
+	 * so it can be saved, restored and owned by
+	 * a single thread.
+	 */
+	class Generator
+	{
+	private:
+		Uint32 _state[4];
+	public:
+		/// Creates a generator with a fixed seed.
+		Generator(Uint32 seed = 0);
+		/// Restarts the sequence from a seed.
+		void seed(Uint32 seed);
+		/// Generates the next raw number.
+		Uint32 next();
+		/// Generates a random integer number.
+		int generate(int min, int max);
+		/// Generates a random decimal number.
+		double generate(double min, double max);
+		/// Get normally distributed value.
+		double boxMuller(double m = 0, double s = 1);
+		/// Loads the generator state from YAML.
+		void load(const YAML::Node& node);
+		/// Saves the generator state to YAML.
+		void save(YAML::Emitter& out) const;
+	};
+
+	/// Initializes the generators.
+	void init(Uint32 seed = 0);
+	/// Gets the generator of a stream.
+	Generator &getStream(Stream stream);
 	/// Loads the RNG from YAML.
 	void load(const YAML::Node& node);
 	/// Saves the RNG to YAML.
@@ -44,6 +79,12 @@ namespace RNG
 	double generate(double min, double max);
 	/// Get normally distributed value.
 	double boxMuller(double m = 0, double s = 1);
+	/// Generates a random integer number from a stream.
+	int generate(Stream stream, int min, int max);
+	/// Generates a random decimal number from a stream.
+	double generate(Stream stream, double min, double max);
+	/// Get normally distributed value from a stream.
+	double boxMuller(Stream stream, double m = 0, double s = 1);
 }
 
 }
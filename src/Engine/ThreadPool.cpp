@@ -0,0 +1,155 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPool.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Starts the worker threads. If a thread can't be created,
+ * the pool simply continues with fewer threads.
+ * @param threads Number of worker threads besides the calling thread.
+ */
+ThreadPool::ThreadPool(int threads) : _threads(), _job(0), _count(0), _next(0), _pending(0), _quit(false)
+{
+	_mutex = SDL_CreateMutex();
+	_start = SDL_CreateCond();
+	_done = SDL_CreateCond();
+	for (int i = 0; i < threads; ++i)
+	{
+		SDL_Thread *thread = SDL_CreateThread(workerThread, this);
+		if (thread == 0)
+		{
+			Log(LOG_WARNING) << "Couldn't create worker thread: " << SDL_GetError();
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+/**
+ * Tells the worker threads to quit and waits for them.
+ */
+ThreadPool::~ThreadPool()
+{
+	SDL_mutexP(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_start);
+	SDL_mutexV(_mutex);
+	for (std::vector<SDL_Thread*>::iterator i = _threads.begin(); i != _threads.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+	SDL_DestroyCond(_done);
+	SDL_DestroyCond(_start);
+	SDL_DestroyMutex(_mutex);
+}
+
+/**
+ * Gets the number of threads that work on a job, including the calling thread.
+ * @return Number of threads.
+ */
+int ThreadPool::getThreads() const
+{
+	return _threads.size() + 1;
+}
+
+/**
+ * Runs all pieces of a job, spread over the worker threads and the calling thread.
+ * Returns when every piece is finished.
+ * @param job The job to run.
+ * @param count Number of pieces in the job.
+ */
+void ThreadPool::execute(Job *job, int count)
+{
+	if (count <= 0)
+		return;
+	if (_threads.empty() || count == 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			job->run(i);
+		}
+		return;
+	}
+
+	SDL_mutexP(_mutex);
+	_job = job;
+	_count = count;
+	_next = 0;
+	_pending = count;
+	SDL_CondBroadcast(_start);
+	SDL_mutexV(_mutex);
+
+	work(false);
+
+	SDL_mutexP(_mutex);
+	while (_pending > 0)
+	{
+		SDL_CondWait(_done, _mutex);
+	}
+	_job = 0;
+	SDL_mutexV(_mutex);
+}
+
+/**
+ * Takes pieces of the current job and runs them until none are left.
+ * Worker threads keep waiting for new jobs afterwards, the calling thread returns.
+ * @param worker Is this a worker thread?
+ */
+void ThreadPool::work(bool worker)
+{
+	SDL_mutexP(_mutex);
+	while (true)
+	{
+		while (worker && !_quit && _next >= _count)
+		{
+			SDL_CondWait(_start, _mutex);
+		}
+		if (_quit || _next >= _count)
+			break;
+
+		int index = _next++;
+		Job *job = _job;
+		SDL_mutexV(_mutex);
+
+		job->run(index);
+
+		SDL_mutexP(_mutex);
+		if (--_pending == 0)
+		{
+			SDL_CondSignal(_done);
+		}
+	}
+	SDL_mutexV(_mutex);
+}
+
+/**
+ * Entry point of the worker threads.
+ * @param pool Pointer to the pool the thread belongs to.
+ * @return Thread exit code.
+ */
+int ThreadPool::workerThread(void *pool)
+{
+	((ThreadPool*)pool)->work(true);
+	return 0;
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_THREADPOOL_H
+#define OPENXCOM_THREADPOOL_H
+
+#include <vector>
+#include <SDL.h>
+
+namespace OpenXcom
+{
+
+/**
+ * A set of worker threads that split independent pieces of work between them.
+ * The thread calling execute() helps out and only returns when all the work is done,
+ * so callers can merge the results right after.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * Work that can be split in a number of independent pieces.
+	 * Each piece must only write to data owned by that piece.
+	 */
+	class Job
+	{
+	public:
+		/// Cleans up the job.
+		virtual ~Job() {}
+		/// Runs a single piece of the job.
+		virtual void run(int index) = 0;
+	};
+private:
+	std::vector<SDL_Thread*> _threads;
+	SDL_mutex *_mutex;
+	SDL_cond *_start, *_done;
+	Job *_job;
+	int _count, _next, _pending;
+	bool _quit;
+	/// Runs pieces of the current job until there are none left.
+	void work(bool worker);
+	/// Entry point of the worker threads.
+	static int workerThread(void *pool);
+public:
+	/// Creates a pool with a number of worker threads.
+	ThreadPool(int threads);
+	/// Stops the worker threads.
+	~ThreadPool();
+	/// Gets the number of threads working on a job.
+	int getThreads() const;
+	/// Runs all pieces of a job.
+	void execute(Job *job, int count);
+};
+
+}
+
+#endif
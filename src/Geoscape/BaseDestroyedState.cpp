@@ -93,4 +93,13 @@ void BaseDestroyedState::btnConfirmClick(Action *)
 	}
 }
 
+/**
+ * Gets the base the aliens destroyed.
+ * @return Pointer to base.
+ */
+Base *BaseDestroyedState::getBase() const
+{
+	return _base;
+}
+
 }
\ No newline at end of file
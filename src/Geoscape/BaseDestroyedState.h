@@ -50,6 +50,8 @@ public:
 	void btnCancelClick(Action *action);
 	/// Handler for clicking the Cydonia mission button.
 	void btnConfirmClick(Action *action);
+	/// Gets the destroyed base.
+	Base *getBase() const;
 
 };
 
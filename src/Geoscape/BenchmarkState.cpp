@@ -0,0 +1,241 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BenchmarkState.h"
+#include <iomanip>
+#include <yaml-cpp/yaml.h>
+#include "../Engine/Game.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Savegame/SavedGame.h"
+#include "../Savegame/GameTime.h"
+#include "../Savegame/Country.h"
+#include "../Savegame/Base.h"
+#include "../Savegame/Ufo.h"
+#include "../Savegame/AlienMission.h"
+#include "GeoscapeState.h"
+
+namespace OpenXcom
+{
+
+typedef void (GeoscapeState::*TimeHandler)();
+
+static const TimeHandler handlers[] = { &GeoscapeState::time5Seconds, &GeoscapeState::time10Minutes, &GeoscapeState::time30Minutes, &GeoscapeState::time1Hour, &GeoscapeState::time1Day, &GeoscapeState::time1Month };
+static const char *handlerNames[] = { "time5Seconds", "time10Minutes", "time30Minutes", "time1Hour", "time1Day", "time1Month" };
+
+/**
+ * Hashes the YAML output of part of the game
+ * so runs can be compared without diffing saves.
+ * @param out YAML emitter.
+ * @return FNV-1a hash of the emitted text.
+ */
+static Uint32 hashYaml(const YAML::Emitter &out)
+{
+	Uint32 hash = 2166136261u;
+	const char *c = out.c_str();
+	for (unsigned int i = 0; i < out.size(); ++i)
+	{
+		hash ^= (unsigned char)c[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Hashes the YAML output of a list of game objects.
+ * @param list List of objects to save.
+ * @return FNV-1a hash of the emitted text.
+ */
+template <typename T>
+static Uint32 hashList(const std::vector<T*> &list)
+{
+	YAML::Emitter out;
+	out << YAML::BeginSeq;
+	for (typename std::vector<T*>::const_iterator i = list.begin(); i != list.end(); ++i)
+	{
+		(*i)->save(out);
+	}
+	out << YAML::EndSeq;
+	return hashYaml(out);
+}
+
+/**
+ * Initializes the benchmark. The saved game to run, the
+ * number of months and the popup policy are taken from the
+ * -benchmarkSave, -benchmarkMonths and -benchmarkPolicy
+ * command line arguments.
+ * @param game Pointer to the core game.
+ */
+BenchmarkState::BenchmarkState(Game *game) : State(game), _geo(0)
+{
+	for (int i = 0; i < TRIGGERS; ++i)
+	{
+		_times[i] = 0;
+		_calls[i] = 0;
+	}
+}
+
+/**
+ * Deletes the Geoscape used for the run.
+ */
+BenchmarkState::~BenchmarkState()
+{
+	delete _geo;
+}
+
+/**
+ * Runs the whole benchmark at once and quits the game,
+ * since there's nobody around to look at the screen.
+ */
+void BenchmarkState::think()
+{
+	State::think();
+
+	if (loadGame())
+	{
+		PopupPolicy policy = POPUP_RETURN;
+		std::string name = Options::getBenchmarkPolicy();
+		if (name == "patrol")
+		{
+			policy = POPUP_PATROL;
+		}
+		else if (name != "return")
+		{
+			Log(LOG_WARNING) << "Benchmark: unknown policy " << name << ", using return";
+		}
+		Uint32 start = SDL_GetTicks();
+		runMonths(Options::getBenchmarkMonths(), policy);
+		report(SDL_GetTicks() - start);
+	}
+	_game->quit();
+}
+
+/**
+ * Loads the saved game and sets up the Geoscape
+ * to run it, starting the alien missions if
+ * it's a brand new game.
+ * @return True if the game was loaded successfully.
+ */
+bool BenchmarkState::loadGame()
+{
+	std::string filename = Options::getBenchmarkSave();
+	SavedGame *s = new SavedGame();
+	try
+	{
+		s->load(filename, _game->getRuleset());
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << "Benchmark: " << e.what();
+		delete s;
+		return false;
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_ERROR) << "Benchmark: " << e.what();
+		delete s;
+		return false;
+	}
+	_game->setSavedGame(s);
+	_geo = new GeoscapeState(_game);
+	if (s->getMonthsPassed() == -1)
+	{
+		s->addMonth();
+		_geo->createStartingMissions();
+	}
+	Log(LOG_INFO) << "Benchmark: loaded " << filename;
+	return true;
+}
+
+/**
+ * Advances the game time the same way the Geoscape timer
+ * does, timing every trigger. Any popups or interceptions
+ * are resolved right away with the given policy,
+ * and the run ends early if all the bases are lost.
+ * @param months Number of months to run.
+ * @param policy How to answer the popups.
+ */
+void BenchmarkState::runMonths(int months, PopupPolicy policy)
+{
+	SavedGame *save = _game->getSavedGame();
+	bool idle = false, checkIdle = true;
+	while (months > 0 && !save->getBases()->empty())
+	{
+		TimeTrigger trigger = save->getTime()->advance();
+		for (int i = trigger; i > TIME_5SEC; --i)
+		{
+			double start = CrossPlatform::getWallTime();
+			(_geo->*handlers[i])();
+			_times[i] += CrossPlatform::getWallTime() - start;
+			_calls[i]++;
+			checkIdle = true;
+		}
+		if (checkIdle)
+		{
+			idle = _geo->isIdle();
+			checkIdle = false;
+		}
+		if (!idle)
+		{
+			double start = CrossPlatform::getWallTime();
+			_geo->time5Seconds();
+			_times[TIME_5SEC] += CrossPlatform::getWallTime() - start;
+			_calls[TIME_5SEC]++;
+			checkIdle = true;
+		}
+		_geo->dismissPopups(policy);
+		if (trigger == TIME_1MONTH)
+		{
+			months--;
+		}
+	}
+	if (months > 0)
+	{
+		Log(LOG_INFO) << "Benchmark: all bases lost, stopping early";
+	}
+}
+
+/**
+ * Logs the time spent in each trigger along with
+ * hashes of the final game state, so regressions in
+ * both speed and behavior can be spotted between runs.
+ * @param wallTime Total running time in milliseconds.
+ */
+void BenchmarkState::report(Uint32 wallTime)
+{
+	SavedGame *save = _game->getSavedGame();
+	GameTime *time = save->getTime();
+	Log(LOG_INFO) << "Benchmark: ran until " << time->getYear() << "-" << time->getMonth() << "-" << time->getDay() << " in " << wallTime << " ms";
+	for (int i = 0; i < TRIGGERS; ++i)
+	{
+		Log(LOG_INFO) << "Benchmark: " << handlerNames[i] << " x" << _calls[i] << ": " << _times[i] << " ms";
+	}
+	Log(LOG_INFO) << "Benchmark: funds " << save->getFunds() << ", bases " << save->getBases()->size() << ", ufos " << save->getUfos()->size();
+
+	YAML::Emitter out;
+	save->save(out);
+	Log(LOG_INFO) << "Benchmark: game hash " << std::hex << std::setfill('0') << std::setw(8) << hashYaml(out);
+	Log(LOG_INFO) << "Benchmark: countries hash " << std::hex << std::setfill('0') << std::setw(8) << hashList(*save->getCountries());
+	Log(LOG_INFO) << "Benchmark: bases hash " << std::hex << std::setfill('0') << std::setw(8) << hashList(*save->getBases());
+	Log(LOG_INFO) << "Benchmark: ufos hash " << std::hex << std::setfill('0') << std::setw(8) << hashList(*save->getUfos());
+	Log(LOG_INFO) << "Benchmark: missions hash " << std::hex << std::setfill('0') << std::setw(8) << hashList(save->getAlienMissions());
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_BENCHMARKSTATE_H
+#define OPENXCOM_BENCHMARKSTATE_H
+
+#include "../Engine/State.h"
+#include "GeoscapeState.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Runs the Geoscape of a saved game without a player
+ * for a number of months at full speed, resolving
+ * any popups with a fixed policy, and reports how long
+ * each time trigger took and the final state of the game.
+ */
+class BenchmarkState : public State
+{
+private:
+	static const int TRIGGERS = 6;
+	GeoscapeState *_geo;
+	double _times[TRIGGERS];
+	int _calls[TRIGGERS];
+
+	/// Loads the saved game to benchmark.
+	bool loadGame();
+	/// Runs the Geoscape for the requested months.
+	void runMonths(int months, PopupPolicy policy);
+	/// Reports the benchmark results.
+	void report(Uint32 wallTime);
+public:
+	/// Creates the Benchmark state.
+	BenchmarkState(Game *game);
+	/// Cleans up the Benchmark state.
+	~BenchmarkState();
+	/// Runs the benchmark.
+	void think();
+};
+
+}
+
+#endif
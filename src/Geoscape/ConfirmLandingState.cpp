@@ -188,4 +188,13 @@ void ConfirmLandingState::btnNoClick(Action *)
 	_game->popState();
 }
 
+/**
+ * Gets the craft that is about to land.
+ * @return Pointer to craft.
+ */
+Craft *ConfirmLandingState::getCraft() const
+{
+	return _craft;
+}
+
 }
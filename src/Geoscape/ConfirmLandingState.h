@@ -50,6 +50,8 @@ public:
 	void btnYesClick(Action *action);
 	/// Handler for clicking the No button.
 	void btnNoClick(Action *action);
+	/// Gets the craft that is about to land.
+	Craft *getCraft() const;
 };
 
 }
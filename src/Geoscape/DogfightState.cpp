@@ -926,21 +926,15 @@ void DogfightState::move()
 		}
 		if(_destroyCraft)
 		{
-			for(std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+			Country *country = _game->getSavedGame()->locateCountry(*_craft);
+			if(country)
 			{
-				if((*country)->getRules()->insideCountry(_craft->getLongitude(), _craft->getLatitude()))
-				{
-					(*country)->addActivityXcom(-_craft->getRules()->getScore());
-					break;
-				}
+				country->addActivityXcom(-_craft->getRules()->getScore());
 			}
-			for(std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+			Region *region = _game->getSavedGame()->locateRegion(*_craft);
+			if(region)
 			{
-				if((*region)->getRules()->insideRegion(_craft->getLongitude(), _craft->getLatitude()))
-				{
-					(*region)->addActivityXcom(-_craft->getRules()->getScore());
-					break;
-				}
+				region->addActivityXcom(-_craft->getRules()->getScore());
 			}
 
 			// Remove the craft.
@@ -952,6 +946,7 @@ void DogfightState::move()
 					{
 						delete *c;
 						(*b)->getCrafts()->erase(c);
+						(*b)->craftsChanged();
 						_craft = 0;
 						break;
 					}
@@ -1017,21 +1012,15 @@ void DogfightState::move()
 		{
 			if(_ufo->getShotDownByCraftId() == _craft->getId())
 			{
-				for(std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+				Country *country = _game->getSavedGame()->locateCountry(*_ufo);
+				if(country)
 				{
-					if((*country)->getRules()->insideCountry(_ufo->getLongitude(), _ufo->getLatitude()))
-					{
-						(*country)->addActivityXcom(_ufo->getRules()->getScore()*2);
-						break;
-					}
+					country->addActivityXcom(_ufo->getRules()->getScore()*2);
 				}
-				for(std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+				Region *region = _game->getSavedGame()->locateRegion(*_ufo);
+				if(region)
 				{
-					if((*region)->getRules()->insideRegion(_ufo->getLongitude(), _ufo->getLatitude()))
-					{
-						(*region)->addActivityXcom(_ufo->getRules()->getScore()*2);
-						break;
-					}
+					region->addActivityXcom(_ufo->getRules()->getScore()*2);
 				}
 				setStatus("STR_UFO_DESTROYED");
 				_game->getResourcePack()->getSoundSet("GEO.CAT")->getSound(10)->play(); //11
@@ -1044,21 +1033,15 @@ void DogfightState::move()
 			{
 				setStatus("STR_UFO_CRASH_LANDS");
 				_game->getResourcePack()->getSoundSet("GEO.CAT")->getSound(10)->play(); //10
-				for(std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+				Country *country = _game->getSavedGame()->locateCountry(*_ufo);
+				if(country)
 				{
-					if((*country)->getRules()->insideCountry(_ufo->getLongitude(), _ufo->getLatitude()))
-					{
-						(*country)->addActivityXcom(_ufo->getRules()->getScore());
-						break;
-					}
+					country->addActivityXcom(_ufo->getRules()->getScore());
 				}
-				for(std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+				Region *region = _game->getSavedGame()->locateRegion(*_ufo);
+				if(region)
 				{
-					if((*region)->getRules()->insideRegion(_ufo->getLongitude(), _ufo->getLatitude()))
-					{
-						(*region)->addActivityXcom(_ufo->getRules()->getScore());
-						break;
-					}
+					region->addActivityXcom(_ufo->getRules()->getScore());
 				}
 			}
 			if (!_globe->insideLand(_ufo->getLongitude(), _ufo->getLatitude()))
@@ -1747,6 +1730,15 @@ Ufo* DogfightState::getUfo() const
 	return _ufo;
 }
 
+/**
+ * Returns the craft associated to this dogfight.
+ * @return Returns pointer to craft object associated to this dogfight.
+ */
+Craft* DogfightState::getCraft() const
+{
+	return _craft;
+}
+
 /**
  * Ends the dogfight.
  */
@@ -141,6 +141,8 @@ public:
 	bool dogfightEnded() const;
 	/// Gets pointer to the UFO in this dogfight.
 	Ufo* getUfo() const;
+	/// Gets pointer to the craft in this dogfight.
+	Craft* getCraft() const;
 	
 };
 
@@ -335,4 +335,23 @@ void GeoscapeCraftState::btnCancelClick(Action *)
 	_game->popState();
 }
 
+/**
+ * Gets the craft shown in the window.
+ * @return Pointer to craft.
+ */
+Craft *GeoscapeCraftState::getCraft() const
+{
+	return _craft;
+}
+
+/**
+ * Gets the waypoint at the last known position of the UFO the
+ * craft lost track of, which is only kept if the player chooses to.
+ * @return Pointer to waypoint, 0 if there's none.
+ */
+Waypoint *GeoscapeCraftState::getWaypoint() const
+{
+	return _waypoint;
+}
+
 }
@@ -60,6 +60,10 @@ public:
 	void btnPatrolClick(Action *action);
 	/// Handler for clicking the Cancel button.
 	void btnCancelClick(Action *action);
+	/// Gets the craft shown in the window.
+	Craft *getCraft() const;
+	/// Gets the waypoint at the last known UFO position.
+	Waypoint *getWaypoint() const;
 };
 
 }
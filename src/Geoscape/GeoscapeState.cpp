@@ -94,6 +94,7 @@
 #include "BaseDefenseState.h"
 #include "BaseDestroyedState.h"
 #include "DefeatState.h"
+#include "RadarCoverage.h"
 #include <ctime>
 #include <algorithm>
 #include <functional>
@@ -504,6 +505,9 @@ void GeoscapeState::timeAdvance()
 		timeSpan = 12 * 5 * 6 * 2 * 24;
 	}
 
+	// While nothing is moving or counting down, the 5 second trigger does nothing,
+	// so it's skipped until one of the longer triggers or itself changes something.
+	bool idle = false, checkIdle = true;
 	for (int i = 0; i < timeSpan && !_pause; ++i)
 	{
 		TimeTrigger trigger;
@@ -520,8 +524,18 @@ void GeoscapeState::timeAdvance()
 			time30Minutes();
 		case TIME_10MIN:
 			time10Minutes();
+			checkIdle = true;
 		case TIME_5SEC:
-			time5Seconds();
+			if (checkIdle)
+			{
+				idle = isIdle();
+				checkIdle = false;
+			}
+			if (!idle)
+			{
+				time5Seconds();
+				checkIdle = true;
+			}
 		}
 	}
 
@@ -531,6 +545,40 @@ void GeoscapeState::timeAdvance()
 	_globe->draw();
 }
 
+/**
+ * Checks if the 5 second trigger would have nothing to do:
+ * there are bases left, no UFO is flying, landed or about
+ * to expire, no craft is on its way anywhere and there
+ * are no waypoints to clean up.
+ * @return True if time5Seconds() can be skipped.
+ */
+bool GeoscapeState::isIdle() const
+{
+	SavedGame *save = _game->getSavedGame();
+	if (save->getBases()->empty() || !save->getWaypoints()->empty())
+	{
+		return false;
+	}
+	for (std::vector<Ufo*>::const_iterator i = save->getUfos()->begin(); i != save->getUfos()->end(); ++i)
+	{
+		if ((*i)->getStatus() != Ufo::CRASHED || (*i)->getSecondsRemaining() == 0)
+		{
+			return false;
+		}
+	}
+	for (std::vector<Base*>::const_iterator i = save->getBases()->begin(); i != save->getBases()->end(); ++i)
+	{
+		for (std::vector<Craft*>::const_iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		{
+			if ((*j)->getDestination() != 0)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 /**
  * Takes care of any game logic that has to
  * run every game second, like craft movement.
@@ -866,29 +914,27 @@ void GeoscapeState::time10Minutes()
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
 		// Fuel consumption for XCOM craft.
-		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		std::vector<Craft*> crafts = (*i)->getCrafts(CRAFT_OUT);
+		for (std::vector<Craft*>::iterator j = crafts.begin(); j != crafts.end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_OUT")
+			(*j)->consumeFuel();
+			if (!(*j)->getLowFuel() && (*j)->getFuel() <= (*j)->getFuelLimit())
 			{
-				(*j)->consumeFuel();
-				if (!(*j)->getLowFuel() && (*j)->getFuel() <= (*j)->getFuelLimit())
-				{
-					(*j)->setLowFuel(true);
-					(*j)->returnToBase();
-					popup(new LowFuelState(_game, (*j), this));
-				}
+				(*j)->setLowFuel(true);
+				(*j)->returnToBase();
+				popup(new LowFuelState(_game, (*j), this));
+			}
 
-				if ((*j)->getDestination() == 0)
+			if ((*j)->getDestination() == 0)
+			{
+				for(std::vector<AlienBase*>::iterator b = _game->getSavedGame()->getAlienBases()->begin(); b != _game->getSavedGame()->getAlienBases()->end(); b++)
 				{
-					for(std::vector<AlienBase*>::iterator b = _game->getSavedGame()->getAlienBases()->begin(); b != _game->getSavedGame()->getAlienBases()->end(); b++)
+					if ((*j)->getDistance(*b) <= (1696 * (1 / 60.0) * (M_PI / 180) ))
 					{
-						if ((*j)->getDistance(*b) <= (1696 * (1 / 60.0) * (M_PI / 180) ))
+						// TODO: move the detection range to the ruleset, or use the pre-defined one (which is 600, but detection range should be 500).
+						if ((50-((*j)->getDistance(*b) / (1696 * (1 / 60.0) * (M_PI / 180) )) * 50 >= RNG::generate(0, 100)) && !(*b)->isDiscovered())
 						{
-							// TODO: move the detection range to the ruleset, or use the pre-defined one (which is 600, but detection range should be 500).
-							if ((50-((*j)->getDistance(*b) / (1696 * (1 / 60.0) * (M_PI / 180) )) * 50 >= RNG::generate(0, 100)) && !(*b)->isDiscovered())
-							{
-								(*b)->setDiscovered(true);
-							}
+							(*b)->setDiscovered(true);
 						}
 					}
 				}
@@ -1001,13 +1047,10 @@ bool ProcessTerrorSite::operator()(TerrorSite *ts) const
 		region->addActivityAlien(1000);
 		//kids, tell your folks... don't ignore terror sites.
 	}
-	for (std::vector<Country*>::iterator k = _game.getCountries()->begin(); k != _game.getCountries()->end(); ++k)
+	Country *country = _game.locateCountry(*ts);
+	if (country)
 	{
-		if ((*k)->getRules()->insideCountry(ts->getLongitude(), ts->getLatitude()))
-		{
-			(*k)->addActivityAlien(1000);
-			break;
-		}
+		country->addActivityAlien(1000);
 	}
 	delete ts;
 	return true;
@@ -1060,40 +1103,39 @@ void GeoscapeState::time30Minutes()
 	// Handle craft maintenance and alien base detection
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
-		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		std::vector<Craft*> crafts = (*i)->getCrafts(CRAFT_REFUELLING);
+		for (std::vector<Craft*>::iterator j = crafts.begin(); j != crafts.end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_REFUELLING")
+			std::string item = (*j)->getRules()->getRefuelItem();
+			if (item == "")
+			{
+				(*j)->refuel();
+			}
+			else
 			{
-				std::string item = (*j)->getRules()->getRefuelItem();
-				if (item == "")
+				if ((*i)->getItems()->getItem(item) > 0)
 				{
+					(*i)->getItems()->removeItem(item);
 					(*j)->refuel();
 				}
 				else
 				{
-					if ((*i)->getItems()->getItem(item) > 0)
-					{
-						(*i)->getItems()->removeItem(item);
-						(*j)->refuel();
-					}
-					else
-					{
-						std::wstringstream ss;
-						ss << _game->getLanguage()->getString("STR_NOT_ENOUGH");
-						ss << _game->getLanguage()->getString(item);
-						ss << _game->getLanguage()->getString("STR_TO_REFUEL");
-						ss << (*j)->getName(_game->getLanguage());
-						ss << _game->getLanguage()->getString("STR_AT_");
-						ss << (*i)->getName();
-						popup(new CraftErrorState(_game, this, ss.str()));
-						(*j)->setStatus("STR_READY");
-					}
+					std::wstringstream ss;
+					ss << _game->getLanguage()->getString("STR_NOT_ENOUGH");
+					ss << _game->getLanguage()->getString(item);
+					ss << _game->getLanguage()->getString("STR_TO_REFUEL");
+					ss << (*j)->getName(_game->getLanguage());
+					ss << _game->getLanguage()->getString("STR_AT_");
+					ss << (*i)->getName();
+					popup(new CraftErrorState(_game, this, ss.str()));
+					(*j)->setStatus(CRAFT_READY);
 				}
 			}
 		}
 	}
 
 	// Handle UFO detection and give aliens points
+	RadarCoverage radar(*_game->getSavedGame()->getBases());
 	for (std::vector<Ufo*>::iterator u = _game->getSavedGame()->getUfos()->begin(); u != _game->getSavedGame()->getUfos()->end(); ++u)
 	{
 		int points = 0;
@@ -1104,50 +1146,26 @@ void GeoscapeState::time30Minutes()
 		case Ufo::FLYING:
 			points++;
 			// Get area
-			for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+			if (Region *region = _game->getSavedGame()->locateRegion(**u))
 			{
-				if ((*k)->getRules()->insideRegion((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					//one point per UFO in-flight per half hour
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				//one point per UFO in-flight per half hour
+				region->addActivityAlien(points);
 			}
 			// Get country
-			for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+			if (Country *country = _game->getSavedGame()->locateCountry(**u))
 			{
-				if ((*k)->getRules()->insideCountry((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					//one point per UFO in-flight per half hour
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				//one point per UFO in-flight per half hour
+				country->addActivityAlien(points);
 			}
 			if (!(*u)->getDetected())
 			{
-				bool detected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); b != _game->getSavedGame()->getBases()->end() && !detected; ++b)
+				bool hyperDetected = false;
+				if (radar.detect(*u, &hyperDetected))
 				{
-					if ((*b)->detect(*u))
-					{
-						detected = true;
-						if((*b)->getHyperDetection())
-						{
-							(*u)->setHyperDetected(true);
-						}
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); c != (*b)->getCrafts()->end() && !detected; ++c)
+					if (hyperDetected)
 					{
-						if ((*c)->getLongitude() == (*b)->getLongitude() && (*c)->getLatitude() == (*b)->getLatitude() && (*c)->getDestination() == 0)
-							continue;
-						if ((*c)->detect(*u))
-						{
-							detected = true;
-						}
+						(*u)->setHyperDetected(true);
 					}
-				}
-				if (detected)
-				{
 					(*u)->setDetected(true);
 					if(!(*u)->getHyperDetected())
 					{
@@ -1161,18 +1179,11 @@ void GeoscapeState::time30Minutes()
 			}
 			else
 			{
-				bool detected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); b != _game->getSavedGame()->getBases()->end() && !detected; ++b)
+				bool hyperDetected = false;
+				bool detected = radar.track(*u, &hyperDetected);
+				if (hyperDetected)
 				{
-					detected = detected || (*b)->insideRadarRange(*u);
-					if((*b)->getHyperDetection())
-					{
-						(*u)->setHyperDetected(true);
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); c != (*b)->getCrafts()->end() && !detected; ++c)
-					{
-						detected = detected || (*c)->detect(*u);
-					}
+					(*u)->setHyperDetected(true);
 				}
 				if (!detected)
 				{
@@ -1211,26 +1222,26 @@ void GeoscapeState::time1Hour()
 	// Handle craft maintenance
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
-		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		// Take both lists first, so crafts finishing repairs wait until next hour to rearm
+		std::vector<Craft*> repairs = (*i)->getCrafts(CRAFT_REPAIRS);
+		std::vector<Craft*> rearming = (*i)->getCrafts(CRAFT_REARMING);
+		for (std::vector<Craft*>::iterator j = repairs.begin(); j != repairs.end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_REPAIRS")
-			{
-				(*j)->repair();
-			}
-			else if ((*j)->getStatus() == "STR_REARMING")
+			(*j)->repair();
+		}
+		for (std::vector<Craft*>::iterator j = rearming.begin(); j != rearming.end(); ++j)
+		{
+			std::string s = (*j)->rearm();
+			if (s != "")
 			{
-				std::string s = (*j)->rearm();
-				if (s != "")
-				{
-					std::wstringstream ss;
-					ss << _game->getLanguage()->getString("STR_NOT_ENOUGH");
-					ss << _game->getLanguage()->getString(s);
-					ss << _game->getLanguage()->getString("STR_TO_REARM");
-					ss << (*j)->getName(_game->getLanguage());
-					ss << _game->getLanguage()->getString("STR_AT_");
-					ss << (*i)->getName();
-					popup(new CraftErrorState(_game, this, ss.str()));
-				}
+				std::wstringstream ss;
+				ss << _game->getLanguage()->getString("STR_NOT_ENOUGH");
+				ss << _game->getLanguage()->getString(s);
+				ss << _game->getLanguage()->getString("STR_TO_REARM");
+				ss << (*j)->getName(_game->getLanguage());
+				ss << _game->getLanguage()->getString("STR_AT_");
+				ss << (*i)->getName();
+				popup(new CraftErrorState(_game, this, ss.str()));
 			}
 		}
 	}
@@ -1325,6 +1336,7 @@ void GeoscapeState::time1Day()
 				(*j)->build();
 				if ((*j)->getBuildTime() == 0)
 				{
+					(*i)->facilitiesChanged();
 					timerReset();
 					popup(new ProductionCompleteState(_game, _game->getLanguage()->getString((*j)->getRules()->getType()), (*i)->getName()));
 				}
@@ -1409,21 +1421,15 @@ void GeoscapeState::time1Day()
 	// handle regional and country points for alien bases
 	for(std::vector<AlienBase*>::const_iterator b = _game->getSavedGame()->getAlienBases()->begin(); b != _game->getSavedGame()->getAlienBases()->end(); ++b)
 	{
-		for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+		Region *region = _game->getSavedGame()->locateRegion(**b);
+		if (region)
 		{
-			if ((*k)->getRules()->insideRegion((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien(5);
-				break;
-			}
+			region->addActivityAlien(5);
 		}
-		for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+		Country *country = _game->getSavedGame()->locateCountry(**b);
+		if (country)
 		{
-			if ((*k)->getRules()->insideCountry((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien(5);
-				break;
-			}
+			country->addActivityAlien(5);
 		}
 	}
 
@@ -1538,6 +1544,79 @@ void GeoscapeState::popup(State *state)
 	_popups.push_back(state);
 }
 
+/**
+ * Resolves all queued popups and interceptions without showing
+ * them, for running the Geoscape without a player. Popups that
+ * would change the game when closed get the outcome of the player
+ * turning them down: base defense battles are called off and
+ * destroyed bases are removed. Craft waiting for orders or about
+ * to land follow the policy, heading back to base or patrolling
+ * where they are. Intercepting craft always break off and head
+ * back to base, since there's nobody to fight, and the timer resumes.
+ * @param policy How to answer the popups.
+ */
+void GeoscapeState::dismissPopups(PopupPolicy policy)
+{
+	SavedGame *save = _game->getSavedGame();
+	std::vector<Base*> destroyedBases;
+	for (std::vector<State*>::iterator i = _popups.begin(); i != _popups.end(); ++i)
+	{
+		if (dynamic_cast<BriefingState*>(*i) != 0 && save->getBattleGame() != 0)
+		{
+			// the base defense battle was already set up, nobody is going to fight it
+			for (std::vector<Base*>::iterator j = save->getBases()->begin(); j != save->getBases()->end(); ++j)
+			{
+				(*j)->setInBattlescape(false);
+			}
+			save->setBattleGame(0);
+		}
+		else if (BaseDestroyedState *destroyed = dynamic_cast<BaseDestroyedState*>(*i))
+		{
+			// removed last, other popups can still refer to its craft
+			destroyedBases.push_back(destroyed->getBase());
+		}
+		else if (ConfirmLandingState *landing = dynamic_cast<ConfirmLandingState*>(*i))
+		{
+			if (policy == POPUP_PATROL)
+				landing->getCraft()->setDestination(0);
+			else
+				landing->getCraft()->returnToBase();
+		}
+		else if (GeoscapeCraftState *craft = dynamic_cast<GeoscapeCraftState*>(*i))
+		{
+			if (policy == POPUP_PATROL)
+				craft->getCraft()->setDestination(0);
+			else
+				craft->getCraft()->returnToBase();
+			delete craft->getWaypoint();
+		}
+		delete *i;
+	}
+	_popups.clear();
+	_dogfights.insert(_dogfights.end(), _dogfightsToBeStarted.begin(), _dogfightsToBeStarted.end());
+	_dogfightsToBeStarted.clear();
+	for (std::vector<DogfightState*>::iterator i = _dogfights.begin(); i != _dogfights.end(); ++i)
+	{
+		(*i)->getCraft()->returnToBase();
+		delete *i;
+	}
+	_dogfights.clear();
+	_minimizedDogfights = 0;
+	for (std::vector<Base*>::iterator i = destroyedBases.begin(); i != destroyedBases.end(); ++i)
+	{
+		std::vector<Base*>::iterator base = std::find(save->getBases()->begin(), save->getBases()->end(), *i);
+		if (base != save->getBases()->end())
+		{
+			delete *base;
+			save->getBases()->erase(base);
+		}
+	}
+	_dogfightStartTimer->stop();
+	_zoomInEffectTimer->stop();
+	_zoomOutEffectTimer->stop();
+	_pause = false;
+}
+
 /**
  * Returns a pointer to the Geoscape globe for
  * access by other substates.
@@ -35,6 +35,9 @@ class DogfightState;
 class Craft;
 class Ufo;
 
+/// How popups are answered when nobody is playing: crafts return to base, or patrol where they stopped.
+enum PopupPolicy { POPUP_RETURN, POPUP_PATROL };
+
 /**
  * Geoscape screen which shows an overview of
  * the world and lets the player manage the game.
@@ -71,6 +74,8 @@ public:
 	void timeDisplay();
 	/// Advances the game timer.
 	void timeAdvance();
+	/// Checks if the 5 second trigger has nothing to do.
+	bool isIdle() const;
 	/// Trigger whenever 5 seconds pass.
 	void time5Seconds();
 	/// Trigger whenever 10 minutes pass.
@@ -87,6 +92,8 @@ public:
 	void timerReset();
 	/// Displays a popup window.
 	void popup(State *state);
+	/// Resolves all popups and interceptions.
+	void dismissPopups(PopupPolicy policy);
 	/// Gets the Geoscape globe.
 	Globe *getGlobe() const;
 	/// Handler for clicking the globe.
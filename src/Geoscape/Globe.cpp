@@ -25,6 +25,7 @@
 #include "../Engine/Timer.h"
 #include "../Resource/ResourcePack.h"
 #include "Polygon.h"
+#include "LandMask.h"
 #include "Polyline.h"
 #include "../Engine/Palette.h"
 #include "../Engine/Game.h"
@@ -527,42 +528,6 @@ double Globe::lastVisibleLat(double lon) const
 	return atan(-cos(_cenLat) * cos(lon - _cenLon)/sin(_cenLat));
 }
 
-/**
- * Checks if a polar point is inside a certain polygon.
- * @param lon Longitude of the point.
- * @param lat Latitude of the point.
- * @param poly Pointer to the polygon.
- * @return True if it's inside, False if it's outside.
- */
-bool Globe::insidePolygon(double lon, double lat, Polygon *poly) const
-{
-	bool backFace = true;
-	for (int i = 0; i < poly->getPoints(); ++i)
-	{
-		backFace = backFace && pointBack(poly->getLongitude(i), poly->getLatitude(i));
-	}
-	if (backFace != pointBack(lon, lat))
-		return false;
-
-	bool c = false;
-	for (int i = 0; i < poly->getPoints(); ++i)
-	{
-		int j = (i + 1) % poly->getPoints();
-
-		Sint16 x, y, x_i, x_j, y_i, y_j;
-		polarToCart(poly->getLongitude(i), poly->getLatitude(i), &x_i, &y_i);
-		polarToCart(poly->getLongitude(j), poly->getLatitude(j), &x_j, &y_j);
-		polarToCart(lon, lat, &x, &y);
-
-		if ( ((y_i > y) != (y_j > y)) &&
-			 (x < (x_j - x_i) * (y - y_i) / (y_j - y_i) + x_i) )
-		{
-			c = !c;
-		}
-	}
-	return c;
-}
-
 /**
  * Loads a series of map polar coordinates in X-Com format,
  * converts them and stores them in a set of polygons.
@@ -733,12 +698,7 @@ void Globe::center(double lon, double lat)
  */
 bool Globe::insideLand(double lon, double lat) const
 {
-	bool inside = false;
-	for (std::list<Polygon*>::iterator i = _game->getResourcePack()->getPolygons()->begin(); i != _game->getResourcePack()->getPolygons()->end() && !inside; ++i)
-	{
-		inside = insidePolygon(lon, lat, *i);
-	}
-	return inside;
+	return _game->getResourcePack()->getLandMask()->insideLand(lon, lat);
 }
 
 /**
@@ -1376,10 +1336,10 @@ void Globe::drawMarkers()
 	// Draw the craft markers
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
-		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		// Hide crafts docked at base
+		for (std::vector<Craft*>::const_iterator j = (*i)->getCrafts(CRAFT_OUT).begin(); j != (*i)->getCrafts(CRAFT_OUT).end(); ++j)
 		{
-			// Hide crafts docked at base
-			if ((*j)->getStatus() != "STR_OUT" || pointBack((*j)->getLongitude(), (*j)->getLatitude()))
+			if (pointBack((*j)->getLongitude(), (*j)->getLatitude()))
 				continue;
 
 			polarToCart((*j)->getLongitude(), (*j)->getLatitude(), &x, &y);
@@ -1493,16 +1453,8 @@ void Globe::getPolygonTextureAndShade(double lon, double lat, int *texture, int
 							 7, 7, 8, 8, 9, 9,10,11,
 							11,12,12,13,13,14,15,15};
 
-	*texture = -1;
+	*texture = _game->getResourcePack()->getLandMask()->getTexture(lon, lat);
 	*shade = worldshades[ CreateShadow::getShadowValue(0, Cord(0.,0.,1.), getSunDirection(lon, lat), 0) ];
-	for (std::list<Polygon*>::iterator i = _game->getResourcePack()->getPolygons()->begin(); i != _game->getResourcePack()->getPolygons()->end(); ++i)
-	{
-		if (insidePolygon(lon, lat, *i))
-		{
-			*texture = (*i)->getTexture();
-			return;
-		}
-	}
 }
 
 /**
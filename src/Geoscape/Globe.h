@@ -68,8 +68,6 @@ private:
 	bool pointBack(double lon, double lat) const;
 	/// Return latitude of last visible to player point on given longitude.
 	double lastVisibleLat(double lon) const;
-	/// Checks if a point is inside a polygon.
-	bool insidePolygon(double lon, double lat, Polygon *poly) const;
 	/// Checks if a target is near a point.
 	bool targetNear(Target* target, int x, int y) const;
 	/// Caches a set of polygons.
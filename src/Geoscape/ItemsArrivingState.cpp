@@ -113,7 +113,7 @@ ItemsArrivingState::ItemsArrivingState(Game *game, GeoscapeState *state) : State
 				{
 					for (std::vector<Craft*>::iterator c = (*i)->getCrafts()->begin(); c != (*i)->getCrafts()->end(); ++c)
 					{
-						if ((*c)->getStatus() != "STR_READY")
+						if ((*c)->getStatus() != CRAFT_READY)
 							continue;
 						for (std::vector<CraftWeapon*>::iterator w = (*c)->getWeapons()->begin(); w != (*c)->getWeapons()->end(); ++w)
 						{
@@ -121,7 +121,7 @@ ItemsArrivingState::ItemsArrivingState(Game *game, GeoscapeState *state) : State
 							if ((*w) != 0 && (*w)->getAmmo() < (*w)->getRules()->getAmmoMax())
 							{
 								(*w)->setRearming(true);
-								(*c)->setStatus("STR_REARMING");
+								(*c)->setStatus(CRAFT_REARMING);
 							}
 						}
 					}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _USE_MATH_DEFINES
+#include "LandMask.h"
+#include <cmath>
+#include <algorithm>
+#include "Polygon.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an all-ocean mask covering the globe.
+ * @param resolution Number of cells per degree.
+ */
+LandMask::LandMask(int resolution) : _resolution(resolution < 1 ? 1 : resolution)
+{
+	_width = 360 * _resolution;
+	_height = 180 * _resolution;
+	_cells.resize(_width * _height, -1);
+}
+
+/**
+ *
+ */
+LandMask::~LandMask()
+{
+}
+
+/**
+ * Rasterizes all the world polygons into the mask. Where
+ * polygons overlap, the first one in the list takes precedence.
+ * @param polygons List of world polygons.
+ */
+void LandMask::build(const std::list<Polygon*> &polygons)
+{
+	_cells.assign(_cells.size(), -1);
+	for (std::list<Polygon*>::const_iterator i = polygons.begin(); i != polygons.end(); ++i)
+	{
+		addPolygon(*i);
+	}
+}
+
+/**
+ * Marks the cells whose center lies inside a polygon
+ * with its texture, treating the polygon's edges as
+ * straight lines in lon/lat space.
+ * @param poly Pointer to polygon.
+ */
+void LandMask::addPolygon(const Polygon *poly)
+{
+	int points = poly->getPoints();
+	std::vector<double> x(points), y(points);
+	double minX = 0, maxX = 0, minY = 0, maxY = 0;
+	for (int i = 0; i < points; ++i)
+	{
+		// Work in cell units, keeping the polygon together across the meridian
+		x[i] = poly->getLongitude(i) * 180 / M_PI * _resolution;
+		y[i] = (poly->getLatitude(i) * 180 / M_PI + 90) * _resolution;
+		if (i > 0)
+		{
+			while (x[i] - x[0] > _width / 2)
+				x[i] -= _width;
+			while (x[0] - x[i] > _width / 2)
+				x[i] += _width;
+		}
+		if (i == 0 || x[i] < minX)
+			minX = x[i];
+		if (i == 0 || x[i] > maxX)
+			maxX = x[i];
+		if (i == 0 || y[i] < minY)
+			minY = y[i];
+		if (i == 0 || y[i] > maxY)
+			maxY = y[i];
+	}
+
+	int y1 = std::max(0, (int)floor(minY)), y2 = std::min(_height - 1, (int)floor(maxY));
+	int x1 = (int)floor(minX), x2 = (int)floor(maxX);
+	for (int cy = y1; cy <= y2; ++cy)
+	{
+		double py = cy + 0.5;
+		for (int cx = x1; cx <= x2; ++cx)
+		{
+			double px = cx + 0.5;
+			bool c = false;
+			for (int i = 0, j = points - 1; i < points; j = i++)
+			{
+				if ( ((y[i] > py) != (y[j] > py)) &&
+					 (px < (x[j] - x[i]) * (py - y[i]) / (y[j] - y[i]) + x[i]) )
+				{
+					c = !c;
+				}
+			}
+			if (c)
+			{
+				Sint8 &cell = _cells[((cx % _width + _width) % _width) + cy * _width];
+				if (cell == -1)
+				{
+					cell = poly->getTexture();
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Returns the texture of the land at a polar point.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return Texture ID, or -1 if it's ocean.
+ */
+int LandMask::getTexture(double lon, double lat) const
+{
+	int x = (int)floor(lon * 180 / M_PI * _resolution) % _width;
+	if (x < 0)
+		x += _width;
+	int y = (int)floor((lat * 180 / M_PI + 90) * _resolution);
+	if (y < 0)
+		y = 0;
+	else if (y >= _height)
+		y = _height - 1;
+	return _cells[x + y * _width];
+}
+
+/**
+ * Checks if a polar point is on land.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return True if it's on land, False if it's ocean.
+ */
+bool LandMask::insideLand(double lon, double lat) const
+{
+	return getTexture(lon, lat) != -1;
+}
+
+}
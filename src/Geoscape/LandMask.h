@@ -0,0 +1,60 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_LANDMASK_H
+#define OPENXCOM_LANDMASK_H
+
+#include <list>
+#include <vector>
+#include <SDL.h>
+
+namespace OpenXcom
+{
+
+class Polygon;
+
+/**
+ * Raster of the world map's land in lon/lat space.
+ * Each cell stores the texture of the polygon covering
+ * its center, or -1 for ocean, so land checks don't depend
+ * on the globe's current view and take constant time.
+ */
+class LandMask
+{
+private:
+	int _resolution, _width, _height;
+	std::vector<Sint8> _cells;
+
+	/// Adds a polygon's cells to the mask.
+	void addPolygon(const Polygon *poly);
+public:
+	/// Creates an empty land mask.
+	LandMask(int resolution);
+	/// Cleans up the land mask.
+	~LandMask();
+	/// Builds the mask from the world polygons.
+	void build(const std::list<Polygon*> &polygons);
+	/// Gets the texture at a point.
+	int getTexture(double lon, double lat) const;
+	/// Checks if a point is on land.
+	bool insideLand(double lon, double lat) const;
+};
+
+}
+
+#endif
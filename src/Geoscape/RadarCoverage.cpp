@@ -0,0 +1,215 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _USE_MATH_DEFINES
+#include "RadarCoverage.h"
+#include <cmath>
+#include <algorithm>
+#include "../Savegame/Base.h"
+#include "../Savegame/BaseFacility.h"
+#include "../Ruleset/RuleBaseFacility.h"
+#include "../Savegame/Craft.h"
+#include "../Ruleset/RuleCraft.h"
+#include "../Savegame/Ufo.h"
+#include "../Engine/RNG.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Goes through all the bases and their crafts and
+ * stores the position and range of every radar
+ * in working order.
+ * @param bases List of bases.
+ */
+RadarCoverage::RadarCoverage(const std::vector<Base*> &bases)
+{
+	for (std::vector<Base*>::const_iterator b = bases.begin(); b != bases.end(); ++b)
+	{
+		Station station;
+		toVector(*b, &station.x, &station.y, &station.z);
+		station.range = toRange(0);
+		station.hyperDetection = (*b)->getHyperDetection();
+		for (std::vector<BaseFacility*>::const_iterator i = (*b)->getFacilities()->begin(); i != (*b)->getFacilities()->end(); ++i)
+		{
+			RuleBaseFacility *rules = (*i)->getRules();
+			if ((*i)->getBuildTime() != 0 || rules->getRadarRange() == 0)
+				continue;
+			Radar radar;
+			radar.x = station.x;
+			radar.y = station.y;
+			radar.z = station.z;
+			radar.range = toRange(rules->getRadarRange());
+			radar.chance = rules->getRadarChance();
+			radar.hyperwave = rules->isHyperwave();
+			radar.docked = false;
+			station.range = std::min(station.range, radar.range);
+			_facilities.push_back(radar);
+		}
+		station.facilities = _facilities.size();
+		for (std::vector<Craft*>::const_iterator c = (*b)->getCrafts()->begin(); c != (*b)->getCrafts()->end(); ++c)
+		{
+			if ((*c)->getRules()->getRadarRange() == 0)
+				continue;
+			Radar radar;
+			toVector(*c, &radar.x, &radar.y, &radar.z);
+			radar.range = toRange((*c)->getRules()->getRadarRange());
+			radar.chance = 0;
+			radar.hyperwave = false;
+			radar.docked = ((*c)->getLongitude() == (*b)->getLongitude() && (*c)->getLatitude() == (*b)->getLatitude() && (*c)->getDestination() == 0);
+			_crafts.push_back(radar);
+		}
+		station.crafts = _crafts.size();
+		_bases.push_back(station);
+	}
+}
+
+/**
+ *
+ */
+RadarCoverage::~RadarCoverage()
+{
+}
+
+/**
+ * Converts the position of a target into
+ * a point on the unit sphere.
+ * @param target Pointer to target.
+ * @param x Pointer to the X coordinate.
+ * @param y Pointer to the Y coordinate.
+ * @param z Pointer to the Z coordinate.
+ */
+void RadarCoverage::toVector(const Target *target, double *x, double *y, double *z)
+{
+	double cosLat = cos(target->getLatitude());
+	*x = cosLat * cos(target->getLongitude());
+	*y = cosLat * sin(target->getLongitude());
+	*z = sin(target->getLatitude());
+}
+
+/**
+ * Converts a radar range into the cosine of its angle
+ * on the globe, so a target is in range when the dot
+ * product with the radar position is at least this value.
+ * @param nauticalMiles Radar range.
+ * @return Cosine of the range, or -1 if it covers the whole globe.
+ */
+double RadarCoverage::toRange(int nauticalMiles)
+{
+	double angle = nauticalMiles * (1 / 60.0) * (M_PI / 180);
+	if (angle >= M_PI)
+		return -1;
+	return cos(angle);
+}
+
+/**
+ * Attempts to detect a UFO with the radars, going through
+ * the bases in order, same as Base::detect and Craft::detect.
+ * Each base with radars in range rolls its chance, unless
+ * it has a hyperwave decoder in range; crafts docked in the
+ * base don't help.
+ * @param ufo Pointer to the UFO.
+ * @param hyperDetected Set to true if a base with a hyperwave decoder detected the UFO.
+ * @return True if the UFO was detected.
+ */
+bool RadarCoverage::detect(const Ufo *ufo, bool *hyperDetected) const
+{
+	double x, y, z;
+	toVector(ufo, &x, &y, &z);
+	unsigned int facility = 0, craft = 0;
+	for (std::vector<Station>::const_iterator b = _bases.begin(); b != _bases.end(); ++b)
+	{
+		bool detected = false, hyperwave = false;
+		int chance = 0;
+		for (; facility != b->facilities; ++facility)
+		{
+			const Radar &radar = _facilities[facility];
+			if (!hyperwave && radar.x * x + radar.y * y + radar.z * z >= radar.range)
+			{
+				if (radar.hyperwave)
+				{
+					hyperwave = true;
+				}
+				chance += radar.chance;
+			}
+		}
+		if (hyperwave)
+		{
+			detected = true;
+		}
+		else if (chance != 0)
+		{
+			chance = (chance * 100 + ufo->getVisibility()) / 100;
+			detected = (RNG::generate(0, 100) < chance);
+		}
+		if (detected)
+		{
+			if (b->hyperDetection)
+			{
+				*hyperDetected = true;
+			}
+			return true;
+		}
+		for (; craft != b->crafts; ++craft)
+		{
+			const Radar &radar = _crafts[craft];
+			if (!radar.docked && radar.x * x + radar.y * y + radar.z * z >= radar.range)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks if a detected UFO is still inside the range of any
+ * radar, going through the bases in order. Bases with a
+ * hyperwave decoder keep it hyper-detected, same as before.
+ * @param ufo Pointer to the UFO.
+ * @param hyperDetected Set to true if a base with a hyperwave decoder was checked.
+ * @return True if the UFO is still being tracked.
+ */
+bool RadarCoverage::track(const Ufo *ufo, bool *hyperDetected) const
+{
+	double x, y, z;
+	toVector(ufo, &x, &y, &z);
+	unsigned int craft = 0;
+	for (std::vector<Station>::const_iterator b = _bases.begin(); b != _bases.end(); ++b)
+	{
+		if (b->hyperDetection)
+		{
+			*hyperDetected = true;
+		}
+		if (b->x * x + b->y * y + b->z * z >= b->range)
+		{
+			return true;
+		}
+		for (; craft != b->crafts; ++craft)
+		{
+			const Radar &radar = _crafts[craft];
+			if (radar.x * x + radar.y * y + radar.z * z >= radar.range)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_RADARCOVERAGE_H
+#define OPENXCOM_RADARCOVERAGE_H
+
+#include <vector>
+
+namespace OpenXcom
+{
+
+class Base;
+class Target;
+class Ufo;
+
+/**
+ * Snapshot of the radar coverage of all the XCom bases and
+ * crafts, taken once per detection pass. Radar positions are
+ * stored as unit vectors and ranges as cosines, so checking
+ * a UFO against every radar only takes dot products.
+ */
+class RadarCoverage
+{
+private:
+	struct Radar
+	{
+		double x, y, z, range;
+		int chance;
+		bool hyperwave, docked;
+	};
+	struct Station
+	{
+		double x, y, z, range;
+		bool hyperDetection;
+		// End of the base's radars in the facility and craft lists
+		unsigned int facilities, crafts;
+	};
+	std::vector<Station> _bases;
+	std::vector<Radar> _facilities, _crafts;
+
+	/// Gets the unit vector of a target.
+	static void toVector(const Target *target, double *x, double *y, double *z);
+	/// Gets the cosine of a radar range.
+	static double toRange(int nauticalMiles);
+public:
+	/// Takes the radar coverage of the bases.
+	RadarCoverage(const std::vector<Base*> &bases);
+	/// Cleans up the radar coverage.
+	~RadarCoverage();
+	/// Attempts to detect a UFO.
+	bool detect(const Ufo *ufo, bool *hyperDetected) const;
+	/// Checks if a detected UFO is still tracked.
+	bool track(const Ufo *ufo, bool *hyperDetected) const;
+};
+
+}
+
+#endif
@@ -285,6 +285,7 @@ void NewBattleState::initSave()
 	save->getBases()->push_back(base);
 	_craft = new Craft(rule->getCraft("STR_SKYRANGER"), base, 1);
 	base->getCrafts()->push_back(_craft);
+	base->craftsChanged();
 
 	// Generate soldiers
 	for (int i = 0; i < 30; ++i)
@@ -440,6 +441,7 @@ void NewBattleState::btnRandomClick(Action *)
 	_craft->setRules(_game->getRuleset()->getCraft(_crafts[_selCraft]));
 
 	base->getCrafts()->push_back(_craft);
+	base->craftsChanged();
 
 	// Generate soldiers
 	for (int i = 0; i < 30; ++i)
@@ -27,6 +27,7 @@
 #include "../Engine/Language.h"
 #include "../Engine/Palette.h"
 #include "../Engine/Options.h"
+#include "../Engine/BackgroundWriter.h"
 #include "../Interface/Text.h"
 #include "../Interface/TextList.h"
 #include "../Interface/TextEdit.h"
@@ -41,7 +42,7 @@ namespace OpenXcom
  * @param game Pointer to the core game.
  * @param geo True to use Geoscape palette, false to use Battlescape palette.
  */
-SaveState::SaveState(Game *game, bool geo) : SavedGameState(game, geo), _selected(L""), _previousSelectedRow(-1), _selectedRow(-1)
+SaveState::SaveState(Game *game, bool geo) : SavedGameState(game, geo), _selected(L""), _previousSelectedRow(-1), _selectedRow(-1), _writer(0), _filename(""), _oldName(""), _newName("")
 {
 	// Create objects
 	
@@ -73,7 +74,7 @@ SaveState::SaveState(Game *game, bool geo) : SavedGameState(game, geo), _selecte
  */
 SaveState::~SaveState()
 {
-
+	delete _writer;
 }
 
 /**
@@ -136,13 +137,14 @@ void SaveState::lstSavesPress(Action *action)
 }
 
 /**
- * Saves the selected save.
+ * Saves the selected save. The game is turned into YAML right away,
+ * then the file is written in the background, and the screen closes once it's done.
  * @param action Pointer to an action.
  */
 void SaveState::edtSaveKeyPress(Action *action)
 {
-	if (action->getDetails()->key.keysym.sym == SDLK_RETURN ||
-		action->getDetails()->key.keysym.sym == SDLK_KP_ENTER)
+	if (_writer == 0 && (action->getDetails()->key.keysym.sym == SDLK_RETURN ||
+		action->getDetails()->key.keysym.sym == SDLK_KP_ENTER))
 	{
 		updateStatus("STR_SAVING_GAME");
 		try
@@ -154,43 +156,73 @@ void SaveState::edtSaveKeyPress(Action *action)
 			std::string selected = Language::wstrToUtf8(_selected);
 			std::string filename = Language::wstrToUtf8(_edtSave->getText());
 #endif
-			_game->getSavedGame()->save(filename);
-			std::string oldName = Options::getUserFolder() + selected + ".sav";
-			std::string newName = Options::getUserFolder() + filename + ".sav";
-			if (_selectedRow > 0 && oldName != newName)
-			{
-				if (!CrossPlatform::deleteFile(oldName))
-				{
-					throw Exception("Failed to overwrite save");
-				}
-			}
-			_game->popState();
-			_game->popState();
+			_oldName = Options::getUserFolder() + selected + ".sav";
+			_newName = Options::getUserFolder() + filename + ".sav";
+			_filename = filename;
+			_writer = _game->getSavedGame()->saveBackground(filename);
 		}
 		catch (Exception &e)
 		{
-			_edtSave->setVisible(false);
-			Log(LOG_ERROR) << e.what();
-			std::wstringstream error;
-			error << _game->getLanguage()->getString("STR_SAVE_UNSUCCESSFUL") << L'\x02' << Language::utf8ToWstr(e.what());
-			if (_geo)
-				_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(8)+10, "BACK01.SCR", 6));
-			else
-				_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(0), "TAC00.SCR", -1));
+			saveError(e.what());
 		}
 		catch (YAML::Exception &e)
 		{
-			_edtSave->setVisible(false);
-			Log(LOG_ERROR) << e.what();
-			std::wstringstream error;
-			error <<
-			_game->getLanguage()->getString("STR_SAVE_UNSUCCESSFUL") << L'\x02' << Language::utf8ToWstr(e.what());
-			if (_geo)
-				_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(8)+10, "BACK01.SCR", 6));
-			else
-				_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(0), "TAC00.SCR", -1));
+			saveError(e.what());
 		}
 	}
 }
 
+/**
+ * Checks on the save being written, and once it's done
+ * removes the overwritten save and closes the screen.
+ */
+void SaveState::think()
+{
+	SavedGameState::think();
+	if (_writer == 0 || !_writer->isDone())
+		return;
+
+	bool success = _writer->wait();
+	std::string error = _writer->getError();
+	delete _writer;
+	_writer = 0;
+	try
+	{
+		if (!success)
+		{
+			throw Exception(error);
+		}
+		_game->getSavedGame()->indexSave(_filename);
+		if (_selectedRow > 0 && _oldName != _newName)
+		{
+			if (!CrossPlatform::deleteFile(_oldName))
+			{
+				throw Exception("Failed to overwrite save");
+			}
+		}
+		_game->popState();
+		_game->popState();
+	}
+	catch (Exception &e)
+	{
+		saveError(e.what());
+	}
+}
+
+/**
+ * Shows the error message of a failed save.
+ * @param message Error message.
+ */
+void SaveState::saveError(const std::string &message)
+{
+	_edtSave->setVisible(false);
+	Log(LOG_ERROR) << message;
+	std::wstringstream error;
+	error << _game->getLanguage()->getString("STR_SAVE_UNSUCCESSFUL") << L'\x02' << Language::utf8ToWstr(message);
+	if (_geo)
+		_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(8)+10, "BACK01.SCR", 6));
+	else
+		_game->pushState(new ErrorMessageState(_game, error.str(), Palette::blockOffset(0), "TAC00.SCR", -1));
+}
+
 }
@@ -26,6 +26,7 @@ namespace OpenXcom
 {
 
 class TextEdit;
+class BackgroundWriter;
 
 /**
  * Save Game screen for listing info on available
@@ -37,6 +38,10 @@ private:
 	TextEdit *_edtSave;
 	std::wstring _selected;
 	int _previousSelectedRow, _selectedRow;
+	BackgroundWriter *_writer;
+	std::string _filename, _oldName, _newName;
+	/// Shows an error message for a failed save.
+	void saveError(const std::string &message);
 public:
 	/// Creates the Save Game state.
 	SaveState(Game *game, bool geo);
@@ -44,6 +49,8 @@ public:
 	~SaveState();
 	/// Updates the savegame list.
 	void updateList();
+	/// Finishes the save once it's written.
+	void think();
 	/// Handler for pressing a key on the Save edit.
 	void edtSaveKeyPress(Action *action);
 	/// Handler for clicking the Saves list.
@@ -30,6 +30,7 @@
 #include "NoteState.h"
 #include "LanguageState.h"
 #include "MainMenuState.h"
+#include "../Geoscape/BenchmarkState.h"
 
 namespace OpenXcom
 {
@@ -117,7 +118,13 @@ void StartState::think()
 		break;
 	case LOADING_SUCCESSFUL:
 		Log(LOG_INFO) << "OpenXcom started successfully!";
-		if (Options::getString("language") == "" || Options::getString("language") == "~")
+		if (Options::getBenchmarkSave() != "")
+		{
+			std::string language = Options::getString("language");
+			_game->loadLanguage((language == "" || language == "~") ? "English" : language);
+			_game->setState(new BenchmarkState(_game));
+		}
+		else if (Options::getString("language") == "" || Options::getString("language") == "~")
 		{
 			_game->setState(new NoteState(_game));
 		}
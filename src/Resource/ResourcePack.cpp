@@ -25,6 +25,7 @@
 #include "../Geoscape/Globe.h"
 #include "../Geoscape/Polygon.h"
 #include "../Geoscape/Polyline.h"
+#include "../Geoscape/LandMask.h"
 #include "../Engine/SoundSet.h"
 
 namespace OpenXcom
@@ -33,7 +34,7 @@ namespace OpenXcom
 /**
  * Initializes a blank resource set pointing to a folder.
  */
-ResourcePack::ResourcePack() : _palettes(), _fonts(), _surfaces(), _sets(), _polygons(), _musics()
+ResourcePack::ResourcePack() : _palettes(), _fonts(), _surfaces(), _sets(), _polygons(), _polylines(), _landMask(0), _musics()
 {
 }
 
@@ -62,6 +63,7 @@ ResourcePack::~ResourcePack()
 	{
 		delete *i;
 	}
+	delete _landMask;
 	for (std::map<std::string, Palette*>::iterator i = _palettes.begin(); i != _palettes.end(); ++i)
 	{
 		delete i->second;
@@ -124,6 +126,15 @@ std::list<Polyline*> *ResourcePack::getPolylines()
 	return &_polylines;
 }
 
+/**
+ * Returns the land mask built from the world polygons.
+ * @return Pointer to the land mask.
+ */
+LandMask *ResourcePack::getLandMask() const
+{
+	return _landMask;
+}
+
 /**
  * Returns a specific music from the resource set.
  * @param name Name of the music.
@@ -34,6 +34,7 @@ class Font;
 class Palette;
 class Polygon;
 class Polyline;
+class LandMask;
 class Music;
 class SoundSet;
 class SavedBattleGame;
@@ -59,6 +60,7 @@ protected:
 	std::map<std::string, SoundSet*> _sounds;
 	std::list<Polygon*> _polygons;
 	std::list<Polyline*> _polylines;
+	LandMask *_landMask;
 	std::map<std::string, Music*> _musics;
 	std::vector<Uint16> _voxelData;
 public:
@@ -76,6 +78,8 @@ public:
 	std::list<Polygon*> *getPolygons();
 	/// Gets the list of world polylines.
 	std::list<Polyline*> *getPolylines();
+	/// Gets the world land mask.
+	LandMask *getLandMask() const;
 	/// Gets a particular music.
 	Music *getMusic(const std::string &name) const;
 	/// Gets a particular sound set.
@@ -31,6 +31,7 @@
 #include "../Geoscape/Globe.h"
 #include "../Geoscape/Polygon.h"
 #include "../Geoscape/Polyline.h"
+#include "../Geoscape/LandMask.h"
 #include "../Interface/TextButton.h"
 #include "../Interface/Window.h"
 #include "../Savegame/SavedBattleGame.h"
@@ -218,6 +219,8 @@ XcomResourcePack::XcomResourcePack() : ResourcePack()
 	std::stringstream s;
 	s << "GEODATA/" << "WORLD.DAT";
 	Globe::loadDat(CrossPlatform::getDataFile(s.str()), &_polygons);
+	_landMask = new LandMask(Options::getInt("globeLandResolution"));
+	_landMask->build(_polygons);
 
 	// Load polylines (extracted from game)
 	// -10 = Start of line
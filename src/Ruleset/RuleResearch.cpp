@@ -17,11 +17,13 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "RuleResearch.h"
+#include <algorithm>
+#include <functional>
 
 namespace OpenXcom
 {
 
-RuleResearch::RuleResearch(const std::string & name) : _name(name), _lookup(""), _cost(0), _points(0), _getOneFree(0), _stringTemplate(0), _requires(0), _needItem(false)
+RuleResearch::RuleResearch(const std::string & name) : _name(name), _lookup(""), _cost(0), _points(0), _getOneFree(0), _stringTemplate(0), _requires(0), _needItem(false), _index(-1)
 {
 }
 
@@ -183,4 +185,109 @@ const std::vector<std::string> & RuleResearch::getRequirements() const
 	return _requires;
 }
 
+/**
+ * Resolves the names of the dependencies, unlocks and requirements
+ * of this research into rules, so checking them doesn't need any
+ * lookups. Unknown dependencies and requirements resolve to 0 and
+ * can never be met, while unknown unlocks are ignored.
+ * @param index Position of this research in the research list.
+ * @param research Map of all the research rules.
+ */
+void RuleResearch::link(int index, const std::map<std::string, RuleResearch *> & research)
+{
+	_index = index;
+	_dependencyRules.clear();
+	_unlockRules.clear();
+	_requireRules.clear();
+	_dependents.clear();
+	for (std::vector<std::string>::const_iterator i = _dependencies.begin(); i != _dependencies.end(); ++i)
+	{
+		std::map<std::string, RuleResearch *>::const_iterator r = research.find(*i);
+		_dependencyRules.push_back(r != research.end() ? r->second : 0);
+	}
+	for (std::vector<std::string>::const_iterator i = _unlocks.begin(); i != _unlocks.end(); ++i)
+	{
+		std::map<std::string, RuleResearch *>::const_iterator r = research.find(*i);
+		if (r != research.end())
+		{
+			_unlockRules.push_back(r->second);
+		}
+	}
+	for (std::vector<std::string>::const_iterator i = _requires.begin(); i != _requires.end(); ++i)
+	{
+		std::map<std::string, RuleResearch *>::const_iterator r = research.find(*i);
+		_requireRules.push_back(r != research.end() ? r->second : 0);
+	}
+}
+
+/**
+ * Adds a research which has this one as a dependency
+ * or unlocks it, so it can be checked when this one
+ * is discovered.
+ * @param research Dependent research.
+ */
+void RuleResearch::addDependent(RuleResearch * research)
+{
+	_dependents.push_back(research);
+}
+
+/** @brief Compare research by list position.
+ * This function object orders research the same way as the research list.
+ */
+struct CompareResearchIndex: public std::binary_function<const RuleResearch *, const RuleResearch *, bool>
+{
+	/// Check if the first research comes before the second.
+	bool operator()(const RuleResearch *a, const RuleResearch *b) const { return a->getIndex() < b->getIndex(); }
+};
+
+/**
+ * Sorts the dependents in the same order as the research
+ * list and removes any duplicates.
+ */
+void RuleResearch::sortDependents()
+{
+	std::sort(_dependents.begin(), _dependents.end(), CompareResearchIndex());
+	_dependents.erase(std::unique(_dependents.begin(), _dependents.end()), _dependents.end());
+}
+
+/**
+ * @return The position of this research in the research list, or -1 if it's not linked.
+ */
+int RuleResearch::getIndex() const
+{
+	return _index;
+}
+
+/**
+ * @return The dependencies of this research, 0 for unknown ones.
+ */
+const std::vector<const RuleResearch *> & RuleResearch::getDependencyRules() const
+{
+	return _dependencyRules;
+}
+
+/**
+ * @return The research unlocked by this research.
+ */
+const std::vector<const RuleResearch *> & RuleResearch::getUnlockRules() const
+{
+	return _unlockRules;
+}
+
+/**
+ * @return The requirements of this research, 0 for unknown ones.
+ */
+const std::vector<const RuleResearch *> & RuleResearch::getRequirementRules() const
+{
+	return _requireRules;
+}
+
+/**
+ * @return The research that depends on or unlocks this one, in research list order.
+ */
+const std::vector<RuleResearch *> & RuleResearch::getDependents() const
+{
+	return _dependents;
+}
+
 }
@@ -20,6 +20,7 @@
 #define OPENXCOM_RULERESEARCH_H
 
 #include <string>
+#include <map>
 #include <vector>
 #include <yaml-cpp/yaml.h>
 
@@ -42,6 +43,9 @@ class RuleResearch
 	int _cost, _points;
 	std::vector<std::string> _dependencies, _unlocks, _getOneFree, _stringTemplate, _requires;
 	bool _needItem;
+	int _index;
+	std::vector<const RuleResearch *> _dependencyRules, _unlockRules, _requireRules;
+	std::vector<RuleResearch *> _dependents;
 public:
 	RuleResearch(const std::string & name);
 	/// Loads the research from YAML.
@@ -68,6 +72,22 @@ public:
 	const std::vector<std::string> & getStringTemplate() const;
 	/// return the requirements
 	const std::vector<std::string> & getRequirements() const;
+	/// Resolves the research this one refers to.
+	void link(int index, const std::map<std::string, RuleResearch *> & research);
+	/// Adds a research that depends on or unlocks this one.
+	void addDependent(RuleResearch * research);
+	/// Sorts the dependents in research list order.
+	void sortDependents();
+	/// Get the position of this research in the research list
+	int getIndex() const;
+	/// Get the resolved research dependencies
+	const std::vector<const RuleResearch *> & getDependencyRules() const;
+	/// Get the resolved list of unlocked research
+	const std::vector<const RuleResearch *> & getUnlockRules() const;
+	/// Get the resolved research requirements
+	const std::vector<const RuleResearch *> & getRequirementRules() const;
+	/// Get the research that depends on or unlocks this one
+	const std::vector<RuleResearch *> & getDependents() const;
 };
 }
 
@@ -176,6 +176,8 @@ void Ruleset::load(const std::string &source)
 		loadFile(Options::getDataFolder() + "Ruleset/" + source + ".rul");
 	else
 		loadFiles(dirname);
+	indexCities();
+	indexResearch();
 }
 
 /**
@@ -828,6 +830,7 @@ SavedGame *Ruleset::newSave() const
 	{
 		save->getRegions()->push_back(new Region(getRegion(*i)));
 	}
+	save->indexZones();
 
 	// Set up IDs
 	std::map<std::string, int> ids;
@@ -989,8 +992,9 @@ const std::vector<std::string> &Ruleset::getCraftWeaponsList() const
  */
 RuleItem *Ruleset::getItem(const std::string &id) const
 {
-	if (_items.find(id) != _items.end())
-		return _items.find(id)->second;
+	std::map<std::string, RuleItem*>::const_iterator i = _items.find(id);
+	if (i != _items.end())
+		return i->second;
 	else
 		return 0;
 }
@@ -1217,11 +1221,15 @@ RuleInventory *Ruleset::getInventory(const std::string &id) const
 /**
  * Returns the rules for the specified research project.
  * @param id Research project type.
- * @return Rules for the research project.
+ * @return Rules for the research project, 0 if there's no such project.
  */
 RuleResearch *Ruleset::getResearch (const std::string &id) const
 {
-	return _research.find(id)->second;
+	std::map<std::string, RuleResearch *>::const_iterator i = _research.find(id);
+	if (i != _research.end())
+		return i->second;
+	else
+		return 0;
 }
 
 /**
@@ -1304,19 +1312,56 @@ const std::vector<std::string> &Ruleset::getAlienMissionList() const
 	return _alienMissionsIndex;
 }
 
-/** @brief Match a city based on coordinates.
- * This function object compare a city's coordinates with the stored coordinates.
+/**
+ * Rebuilds the lookup of cities by their exact coordinates.
+ * If several cities share the same spot, the first one found
+ * takes precedence.
  */
-class EqualCoordinates: std::unary_function<const City *, bool>
+void Ruleset::indexCities()
 {
-public:
-	/// Remember the coordinates.
-	EqualCoordinates(double lon, double lat) : _lon(lon), _lat(lat) { /* Empty by design */ }
-	/// Compare with stored coordinates.
-	bool operator()(const City *city) const { return city->getLongitude() == _lon && city->getLatitude() == _lat; }
-private:
-	double _lon, _lat;
-};
+	_cityIndex.clear();
+	for (std::map<std::string, RuleRegion*>::const_iterator rr = _regions.begin(); rr != _regions.end(); ++rr)
+	{
+		const std::vector<City*> &cities = *rr->second->getCities();
+		for (std::vector<City*>::const_iterator i = cities.begin(); i != cities.end(); ++i)
+		{
+			_cityIndex.insert(std::make_pair(std::make_pair((*i)->getLongitude(), (*i)->getLatitude()), *i));
+		}
+	}
+}
+
+/**
+ * Links every research rule to the ones it refers to, and
+ * each one to the research depending on or unlocked by it,
+ * so research availability can be worked out from the
+ * discovered research without searching through lists.
+ */
+void Ruleset::indexResearch()
+{
+	for (size_t i = 0; i != _researchIndex.size(); ++i)
+	{
+		_research[_researchIndex[i]]->link(i, _research);
+	}
+	for (std::vector<std::string>::const_iterator i = _researchIndex.begin(); i != _researchIndex.end(); ++i)
+	{
+		RuleResearch *research = _research[*i];
+		for (std::vector<const RuleResearch *>::const_iterator j = research->getDependencyRules().begin(); j != research->getDependencyRules().end(); ++j)
+		{
+			if (*j)
+			{
+				_research[(*j)->getName()]->addDependent(research);
+			}
+		}
+		for (std::vector<const RuleResearch *>::const_iterator j = research->getUnlockRules().begin(); j != research->getUnlockRules().end(); ++j)
+		{
+			_research[(*j)->getName()]->addDependent(research);
+		}
+	}
+	for (std::map<std::string, RuleResearch *>::iterator i = _research.begin(); i != _research.end(); ++i)
+	{
+		i->second->sortDependents();
+	}
+}
 
 /**
  * Find the city at coordinates @a lon, @a lat.
@@ -1327,14 +1372,10 @@ private:
  */
 const City *Ruleset::locateCity(double lon, double lat) const
 {
-	for (std::map<std::string, RuleRegion*>::const_iterator rr = _regions.begin(); rr != _regions.end(); ++rr)
+	std::map<std::pair<double, double>, const City*>::const_iterator i = _cityIndex.find(std::make_pair(lon, lat));
+	if (i != _cityIndex.end())
 	{
-		const std::vector<City*> &cities = *rr->second->getCities();
-		std::vector<City *>::const_iterator citer = std::find_if(cities.begin(), cities.end(), EqualCoordinates(lon, lat));
-		if (citer != cities.end())
-		{
-			return *citer;
-		}
+		return i->second;
 	}
 	return 0;
 }
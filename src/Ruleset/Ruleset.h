@@ -88,11 +88,16 @@ protected:
 	std::vector<std::string> _aliensIndex, _deploymentsIndex, _armorsIndex, _ufopaediaIndex, _researchIndex, _manufactureIndex;
 	std::vector<std::string> _alienMissionsIndex;
 	std::vector<std::vector<int> > _alienItemLevels;
+	std::map<std::pair<double, double>, const City*> _cityIndex;
 
 	/// Loads a ruleset from a YAML file.
 	void loadFile(const std::string &filename);
 	/// Loads all ruleset files from a directory.
 	void loadFiles(const std::string &dirname);
+	/// Indexes all the cities by their coordinates.
+	void indexCities();
+	/// Links the research rules into a dependency graph.
+	void indexResearch();
 public:
 	/// Creates a blank ruleset.
 	Ruleset();
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _USE_MATH_DEFINES
+#include "ZoneIndex.h"
+#include <cmath>
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an empty grid covering the whole globe.
+ */
+ZoneIndex::ZoneIndex() : _cells(LON_CELLS * LAT_CELLS), _all()
+{
+}
+
+/**
+ *
+ */
+ZoneIndex::~ZoneIndex()
+{
+}
+
+/**
+ * Returns the grid column containing a longitude.
+ * Out of range values are clamped to the grid edges.
+ * @param lon Longitude in radians.
+ * @return Column index.
+ */
+int ZoneIndex::getColumn(double lon)
+{
+	int x = (int)floor(lon * LON_CELLS / (2 * M_PI));
+	if (x < 0)
+		return 0;
+	if (x >= LON_CELLS)
+		return LON_CELLS - 1;
+	return x;
+}
+
+/**
+ * Returns the grid row containing a latitude.
+ * Out of range values are clamped to the grid edges.
+ * @param lat Latitude in radians.
+ * @return Row index.
+ */
+int ZoneIndex::getRow(double lat)
+{
+	int y = (int)floor((lat + M_PI_2) * LAT_CELLS / M_PI);
+	if (y < 0)
+		return 0;
+	if (y >= LAT_CELLS)
+		return LAT_CELLS - 1;
+	return y;
+}
+
+/**
+ * Removes all the zones, leaving an empty grid.
+ */
+void ZoneIndex::clear()
+{
+	for (std::vector<std::vector<int> >::iterator i = _cells.begin(); i != _cells.end(); ++i)
+	{
+		i->clear();
+	}
+	_all.clear();
+}
+
+/**
+ * Adds a zone made up of lon/lat boxes, in the same format
+ * as regions and countries, to every cell it overlaps.
+ * Zones must be added in increasing ID order, so each
+ * cell lists them in the same order they were added.
+ * @param id Zone ID.
+ * @param lonMin Minimum longitudes of each box.
+ * @param lonMax Maximum longitudes of each box.
+ * @param latMin Minimum latitudes of each box.
+ * @param latMax Maximum latitudes of each box.
+ */
+void ZoneIndex::addZone(int id, const std::vector<double> &lonMin, const std::vector<double> &lonMax, const std::vector<double> &latMin, const std::vector<double> &latMax)
+{
+	_all.push_back(id);
+	for (unsigned int i = 0; i < lonMin.size(); ++i)
+	{
+		int x1 = getColumn(lonMin[i]), x2 = getColumn(lonMax[i]);
+		int y1 = getRow(latMin[i]), y2 = getRow(latMax[i]);
+		// Boxes crossing the meridian wrap around the grid
+		if (lonMin[i] > lonMax[i])
+		{
+			x2 += LON_CELLS;
+		}
+		for (int x = x1; x <= x2; ++x)
+		{
+			for (int y = y1; y <= y2; ++y)
+			{
+				std::vector<int> &cell = _cells[(x % LON_CELLS) + y * LON_CELLS];
+				if (cell.empty() || cell.back() != id)
+				{
+					cell.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Returns the zones that have an area overlapping the cell
+ * containing a point, in the order they were added. Points
+ * outside the globe's range could be in any zone.
+ * @param lon Longitude in radians.
+ * @param lat Latitude in radians.
+ * @return List of zone IDs to check.
+ */
+const std::vector<int> &ZoneIndex::getZones(double lon, double lat) const
+{
+	if (lon < 0 || lon >= 2 * M_PI || lat < -M_PI_2 || lat >= M_PI_2)
+	{
+		return _all;
+	}
+	return _cells[getColumn(lon) + getRow(lat) * LON_CELLS];
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2010-2012 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OPENXCOM_ZONEINDEX_H
+#define OPENXCOM_ZONEINDEX_H
+
+#include <vector>
+
+namespace OpenXcom
+{
+
+/**
+ * Spatial index of areas on the globe, like the ones
+ * making up regions and countries. The globe is split
+ * into a grid of cells, each one listing the zones whose
+ * areas overlap it, so finding the zone containing a point
+ * only needs to check the few zones in its cell.
+ */
+class ZoneIndex
+{
+private:
+	static const int LON_CELLS = 180, LAT_CELLS = 90;
+	std::vector<std::vector<int> > _cells;
+	std::vector<int> _all;
+
+	/// Gets the cell column of a longitude.
+	static int getColumn(double lon);
+	/// Gets the cell row of a latitude.
+	static int getRow(double lat);
+public:
+	/// Creates an empty zone index.
+	ZoneIndex();
+	/// Cleans up the zone index.
+	~ZoneIndex();
+	/// Removes all zones from the index.
+	void clear();
+	/// Adds the areas of a zone to the index.
+	void addZone(int id, const std::vector<double> &lonMin, const std::vector<double> &lonMax, const std::vector<double> &latMin, const std::vector<double> &latMax);
+	/// Gets the zones that might contain a point.
+	const std::vector<int> &getZones(double lon, double lat) const;
+};
+
+}
+
+#endif
@@ -46,7 +46,7 @@ namespace OpenXcom
  * Initializes an empty base.
  * @param rule Pointer to ruleset.
  */
-Base::Base(const Ruleset *rule) : Target(), _rule(rule), _name(L""), _scientists(0), _engineers(0), _inBattlescape(false), _retaliationTarget(false)
+Base::Base(const Ruleset *rule) : Target(), _rule(rule), _name(L""), _scientists(0), _engineers(0), _inBattlescape(false), _retaliationTarget(false), _facilityTotals(false), _craftStatuses(false)
 {
 	_items = new ItemContainer();
 }
@@ -106,6 +106,7 @@ void Base::load(const YAML::Node &node, SavedGame *save, bool newGame)
 			_facilities.push_back(f);
 		}
 	}
+	facilitiesChanged();
 
 	for (YAML::Iterator i = node["crafts"].begin(); i != node["crafts"].end(); ++i)
 	{
@@ -115,6 +116,7 @@ void Base::load(const YAML::Node &node, SavedGame *save, bool newGame)
 		c->load(*i, _rule, save);		
 		_crafts.push_back(c);
 	}
+	craftsChanged();
 
 	for (YAML::Iterator i = node["soldiers"].begin(); i != node["soldiers"].end(); ++i)
 	{
@@ -299,6 +301,41 @@ std::vector<Craft*> *Base::getCrafts()
 	return &_crafts;
 }
 
+/**
+ * Returns the crafts in the base that currently have
+ * a certain status, in the same order as the craft list.
+ * The lists are only sorted out again after a change,
+ * so periodic checks can skip crafts with nothing to do.
+ * @param status Craft status.
+ * @return Reference to the craft list.
+ */
+const std::vector<Craft*> &Base::getCrafts(CraftStatus status) const
+{
+	if (!_craftStatuses)
+	{
+		for (int i = 0; i < CRAFT_STATUSES; ++i)
+		{
+			_craftsByStatus[i].clear();
+		}
+		for (std::vector<Craft*>::const_iterator i = _crafts.begin(); i != _crafts.end(); ++i)
+		{
+			_craftsByStatus[(*i)->getStatus()].push_back(*i);
+		}
+		_craftStatuses = true;
+	}
+	return _craftsByStatus[status];
+}
+
+/**
+ * Marks the crafts by status as out of date. Must be called
+ * whenever crafts are added or removed from the base, and
+ * is called by the crafts themselves when their status changes.
+ */
+void Base::craftsChanged()
+{
+	_craftStatuses = false;
+}
+
 /**
  * Returns the list of transfers destined
  * to this base.
@@ -396,16 +433,75 @@ bool Base::detect(Target *target) const
  */
 bool Base::insideRadarRange(Target *target) const
 {
-	double range = 0;
+	calculateFacilityTotals();
+	return (getDistance(target) <= _radarRange);
+}
+
+/**
+ * Marks the facility totals as out of date, so they're
+ * worked out again on the next query. Must be called
+ * whenever facilities are added, removed or finish building.
+ */
+void Base::facilitiesChanged()
+{
+	_facilityTotals = false;
+}
+
+/**
+ * Works out all the capacities, detection and defenses provided
+ * by the base's operational facilities in a single pass, so the
+ * many queries made by the base screens and the Geoscape don't
+ * each go through every facility.
+ */
+void Base::calculateFacilityTotals() const
+{
+	if (_facilityTotals)
+	{
+		return;
+	}
+	_quarters = _stores = _laboratories = _workshops = _hangars = _psiLabs = _containment = 0;
+	_defenseValue = _shortRangeDetection = _longRangeDetection = _gravShields = _mindShields = _facilityMaintenance = 0;
+	_radarRange = 0;
+	_hyperDetection = false;
 	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
 	{
-		if ((*i)->getBuildTime() == 0)
+		if ((*i)->getBuildTime() != 0)
+		{
+			continue;
+		}
+		RuleBaseFacility *rules = (*i)->getRules();
+		_quarters += rules->getPersonnel();
+		_stores += rules->getStorage();
+		_laboratories += rules->getLaboratories();
+		_workshops += rules->getWorkshops();
+		_hangars += rules->getCrafts();
+		_psiLabs += rules->getPsiLaboratories();
+		_containment += rules->getAliens();
+		_defenseValue += rules->getDefenseValue();
+		_facilityMaintenance += rules->getMonthlyCost();
+		if (rules->getRadarRange() == 1500)
+		{
+			_shortRangeDetection++;
+		}
+		else if (rules->getRadarRange() > 1500)
+		{
+			_longRangeDetection++;
+		}
+		_radarRange = std::max(_radarRange, rules->getRadarRange() * (1 / 60.0) * (M_PI / 180));
+		if (rules->isHyperwave())
+		{
+			_hyperDetection = true;
+		}
+		if (rules->isGravShield())
+		{
+			_gravShields++;
+		}
+		if (rules->isMindShield())
 		{
-			range = std::max(range, (*i)->getRules()->getRadarRange() * (1 / 60.0) * (M_PI / 180));
+			_mindShields++;
 		}
 	}
-	
-	return (getDistance(target) <= range);
+	_facilityTotals = true;
 }
 
 /**
@@ -528,15 +624,8 @@ int Base::getUsedQuarters() const
  */
 int Base::getAvailableQuarters() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getPersonnel();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _quarters;
 }
 
 /**
@@ -572,15 +661,8 @@ int Base::getUsedStores() const
  */
 int Base::getAvailableStores() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getStorage();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _stores;
 }
 
 /**
@@ -608,15 +690,8 @@ int Base::getUsedLaboratories() const
  */
 int Base::getAvailableLaboratories() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getLaboratories();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _laboratories;
 }
 
 /**
@@ -641,15 +716,8 @@ int Base::getUsedWorkshops() const
  */
 int Base::getAvailableWorkshops() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getWorkshops();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _workshops;
 }
 
 /**
@@ -684,15 +752,8 @@ int Base::getUsedHangars() const
  */
 int Base::getAvailableHangars() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getCrafts();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _hangars;
 }
 
 /**
@@ -751,15 +812,8 @@ int Base::getAllocatedEngineers() const
  */
 int Base::getDefenseValue() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getDefenseValue();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _defenseValue;
 }
 
 /**
@@ -769,15 +823,8 @@ int Base::getDefenseValue() const
  */
 int Base::getShortRangeDetection() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0 && (*i)->getRules()->getRadarRange() == 1500)
-		{
-			total++;
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _shortRangeDetection;
 }
 
 /**
@@ -787,15 +834,8 @@ int Base::getShortRangeDetection() const
  */
 int Base::getLongRangeDetection() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0 && (*i)->getRules()->getRadarRange() > 1500)
-		{
-			total++;
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _longRangeDetection;
 }
 
 /**
@@ -853,15 +893,8 @@ int Base::getPersonnelMaintenance() const
  */
 int Base::getFacilityMaintenance() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getMonthlyCost();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _facilityMaintenance;
 }
 
 /**
@@ -946,14 +979,8 @@ const std::vector<Production *> & Base::getProductions () const
  */
 bool Base::getHyperDetection() const
 {
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0 && (*i)->getRules()->isHyperwave())
-		{
-			return true;
-		}		
-	}
-	return false;
+	calculateFacilityTotals();
+	return _hyperDetection;
 }
 
 /**
@@ -963,15 +990,8 @@ bool Base::getHyperDetection() const
  */
 int Base::getAvailablePsiLabs() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getPsiLaboratories();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _psiLabs;
 }
 
 /**
@@ -1000,7 +1020,7 @@ int Base::getUsedPsiLabs() const
 int Base::getUsedContainment() const
 {
 	int total = 0;
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); ++i)
+	for (std::map<std::string, int>::const_iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); ++i)
 	{
 		if (_rule->getItem((i)->first)->getAlien())
 		{
@@ -1027,15 +1047,8 @@ int Base::getUsedContainment() const
  */
 int Base::getAvailableContainment() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getAliens();
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _containment;
 }
 
 /**
@@ -1074,30 +1087,6 @@ bool Base::getRetaliationTarget() const
 	return _retaliationTarget;
 }
 
-/**
- * Functor to check for mind shield capability.
- */
-struct isMindShield: public std::unary_function<BaseFacility*, bool>
-{
-	/// Check isMindShield() for @a facility.
-	bool operator()(const BaseFacility *facility) const;
-};
-
-/**
- * Only fully operational facilities are checked.
- * @param facility Pointer to the facility to check.
- * @return If @a facility can act as a mind shield.
- */
-bool isMindShield::operator()(const BaseFacility *facility) const
-{
-	if (facility->getBuildTime() != 0)
-	{
-		// Still building this
-		return false;
-	}
-	return (facility->getRules()->isMindShield());
-}
-
 /**
  * Calculate the detection chance of this base.
  * Big bases without mindshields are easier to detect.
@@ -1105,21 +1094,14 @@ bool isMindShield::operator()(const BaseFacility *facility) const
  */
 unsigned Base::getDetectionChance() const
 {
-	unsigned mindShields = std::count_if(_facilities.begin(), _facilities.end(), isMindShield());
-	return (_facilities.size()/6 + 16) / (mindShields + 1);
+	calculateFacilityTotals();
+	return (_facilities.size()/6 + 16) / (_mindShields + 1);
 }
 
 int Base::getGravShields() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0 && (*i)->getRules()->isGravShield())
-		{
-			++total;
-		}
-	}
-	return total;
+	calculateFacilityTotals();
+	return _gravShields;
 }
 
 void Base::setupDefenses()
@@ -1137,7 +1119,7 @@ void Base::setupDefenses()
 	// add vehicles that are in the crafts of the base, if it's not out
 	for (std::vector<Craft*>::iterator c = getCrafts()->begin(); c != getCrafts()->end(); ++c)
 	{
-		if ((*c)->getStatus() != "STR_OUT")
+		if ((*c)->getStatus() != CRAFT_OUT)
 		{
 			for (std::vector<Vehicle*>::iterator i = (*c)->getVehicles()->begin(); i != (*c)->getVehicles()->end(); ++i)
 			{
@@ -1146,7 +1128,7 @@ void Base::setupDefenses()
 		}
 	}
 
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); ++i)
+	for (std::map<std::string, int>::const_iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); ++i)
 	{
 		if (_rule->getItem((i)->first)->isFixed())
 		{
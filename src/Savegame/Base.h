@@ -20,6 +20,7 @@
 #define OPENXCOM_BASE_H
 
 #include "Target.h"
+#include "Craft.h"
 #include <string>
 #include <vector>
 #include <yaml-cpp/yaml.h>
@@ -61,6 +62,15 @@ private:
 	bool _retaliationTarget;
 	std::vector<Vehicle*> _vehicles;
 	std::vector<BaseFacility*> _defenses;
+	mutable bool _facilityTotals, _craftStatuses;
+	mutable std::vector<Craft*> _craftsByStatus[CRAFT_STATUSES];
+	mutable int _quarters, _stores, _laboratories, _workshops, _hangars, _psiLabs, _containment;
+	mutable int _defenseValue, _shortRangeDetection, _longRangeDetection, _gravShields, _mindShields, _facilityMaintenance;
+	mutable double _radarRange;
+	mutable bool _hyperDetection;
+
+	/// Works out the totals of all the operational facilities.
+	void calculateFacilityTotals() const;
 public:
 	/// Creates a new base.
 	Base(const Ruleset *rule);
@@ -78,10 +88,16 @@ public:
 	void setName(const std::wstring &name);
 	/// Gets the base's facilities.
 	std::vector<BaseFacility*> *getFacilities();
+	/// Marks the facility totals as changed.
+	void facilitiesChanged();
 	/// Gets the base's soldiers.
 	std::vector<Soldier*> *getSoldiers();
 	/// Gets the base's crafts.
 	std::vector<Craft*> *getCrafts();
+	/// Gets the base's crafts with a certain status.
+	const std::vector<Craft*> &getCrafts(CraftStatus status) const;
+	/// Marks the craft list as changed.
+	void craftsChanged();
 	/// Gets the base's transfers.
 	std::vector<Transfer*> *getTransfers();
 	/// Gets the base's items.
@@ -912,8 +912,8 @@ void BattleUnit::damage(Position position, int power, ItemDamageType type, bool
 				// fatal wounds
 				if (isWoundable())
 				{
-					if (RNG::generate(0,power) > 2)
-						_fatalWounds[bodypart] += RNG::generate(1,3);
+					if (RNG::generate(RNG::BATTLESCAPE, 0,power) > 2)
+						_fatalWounds[bodypart] += RNG::generate(RNG::BATTLESCAPE, 1,3);
 
 					if (_fatalWounds[bodypart])
 						moraleChange(-_fatalWounds[bodypart]);
@@ -1292,7 +1292,7 @@ void BattleUnit::prepareNewTurn()
 	// suffer from fire
 	if (_fire > 0)
 	{
-		_health -= RNG::generate(5, 10);
+		_health -= RNG::generate(RNG::BATTLESCAPE, 5, 10);
 		_fire--;
 	}
 
@@ -1314,9 +1314,9 @@ void BattleUnit::prepareNewTurn()
 	if (!isOut())
 	{
 		int chance = 100 - (2 * getMorale());
-		if (RNG::generate(1,100) <= chance)
+		if (RNG::generate(RNG::BATTLESCAPE, 1,100) <= chance)
 		{
-			int type = RNG::generate(0,100);
+			int type = RNG::generate(RNG::BATTLESCAPE, 0,100);
 			_status = (type<=33?STATUS_BERSERK:STATUS_PANICKING); // 33% chance of berserk, panic can mean freeze or flee, but that is determined later
 		}
 		else
@@ -1714,11 +1714,11 @@ bool BattleUnit::postMissionProcedures(SavedGame *geoscape)
 	UnitStats *stats = s->getCurrentStats();
 	int healthLoss = stats->health - _health;
 
-	s->setWoundRecovery(RNG::generate((healthLoss*0.5),(healthLoss*1.5)));
+	s->setWoundRecovery(RNG::generate(RNG::BATTLESCAPE, (healthLoss*0.5),(healthLoss*1.5)));
 
 	if (_expBravery && stats->bravery < 100)
 	{
-		if (_expBravery > RNG::generate(0,10)) stats->bravery += 10;
+		if (_expBravery > RNG::generate(RNG::BATTLESCAPE, 0,10)) stats->bravery += 10;
 	}
 	if (_expReactions && stats->reactions < 100)
 	{
@@ -1747,13 +1747,13 @@ bool BattleUnit::postMissionProcedures(SavedGame *geoscape)
 			s->promoteRank();
 		int v;
 		v = 80 - stats->tu;
-		if (v > 0) stats->tu += RNG::generate(0, v/10 + 2);
+		if (v > 0) stats->tu += RNG::generate(RNG::BATTLESCAPE, 0, v/10 + 2);
 		v = 60 - stats->health;
-		if (v > 0) stats->health += RNG::generate(0, v/10 + 2);
+		if (v > 0) stats->health += RNG::generate(RNG::BATTLESCAPE, 0, v/10 + 2);
 		v = 70 - stats->strength;
-		if (v > 0) stats->strength += RNG::generate(0, v/10 + 2);
+		if (v > 0) stats->strength += RNG::generate(RNG::BATTLESCAPE, 0, v/10 + 2);
 		v = 100 - stats->stamina;
-		if (v > 0) stats->stamina += RNG::generate(0, v/10 + 2);
+		if (v > 0) stats->stamina += RNG::generate(RNG::BATTLESCAPE, 0, v/10 + 2);
 		return true;
 	}
 	else
@@ -1773,7 +1773,7 @@ int BattleUnit::improveStat(int exp)
 	if (exp < 3) v = 1;
 	if (exp < 6) v = 2;
 	if (exp < 10) v = 3;
-	return (int)(v/2.0 + RNG::generate(0.0, v));
+	return (int)(v/2.0 + RNG::generate(RNG::BATTLESCAPE, 0.0, v));
 }
 
 /*
@@ -39,6 +39,9 @@
 namespace OpenXcom
 {
 
+/// String IDs of each craft status, used for display and saves.
+static const char *const statusStrings[CRAFT_STATUSES] = {"STR_READY", "STR_OUT", "STR_REPAIRS", "STR_REFUELLING", "STR_REARMING"};
+
 /**
  * Initializes a craft of the specified type and
  * assigns it the latest craft ID available.
@@ -46,7 +49,7 @@ namespace OpenXcom
  * @param base Pointer to base of origin.
  * @param ids List of craft IDs (Leave NULL for no ID).
  */
-Craft::Craft(RuleCraft *rules, Base *base, int id) : MovingTarget(), _rules(rules), _base(base), _id(0), _fuel(0), _damage(0), _interceptionOrder(0), _weapons(), _status("STR_READY"), _lowFuel(false), _inBattlescape(false), _inDogfight(false), _name(L"")
+Craft::Craft(RuleCraft *rules, Base *base, int id) : MovingTarget(), _rules(rules), _base(base), _id(0), _fuel(0), _damage(0), _interceptionOrder(0), _weapons(), _status(CRAFT_READY), _lowFuel(false), _inBattlescape(false), _inDogfight(false), _name(L"")
 {
 	_items = new ItemContainer();
 	if (id != 0)
@@ -166,7 +169,16 @@ void Craft::load(const YAML::Node &node, const Ruleset *rule, SavedGame *save)
 		v->load(*i);
 		_vehicles.push_back(v);
 	}
-	node["status"] >> _status;
+	std::string status;
+	node["status"] >> status;
+	for (int i = 0; i < CRAFT_STATUSES; ++i)
+	{
+		if (status == statusStrings[i])
+		{
+			setStatus((CraftStatus)i);
+			break;
+		}
+	}
 	node["lowFuel"] >> _lowFuel;
 	node["inBattlescape"] >> _inBattlescape;
 	node["inDogfight"] >> _inDogfight;
@@ -217,7 +229,7 @@ void Craft::save(YAML::Emitter &out) const
 		(*i)->save(out);
 	}
 	out << YAML::EndSeq;
-	out << YAML::Key << "status" << YAML::Value << _status;
+	out << YAML::Key << "status" << YAML::Value << getStatusString();
 	out << YAML::Key << "lowFuel" << YAML::Value << _lowFuel;
 	out << YAML::Key << "inBattlescape" << YAML::Value << _inBattlescape;
 	out << YAML::Key << "inDogfight" << YAML::Value << false;
@@ -318,26 +330,46 @@ Base *Craft::getBase() const
 void Craft::setBase(Base *base)
 {
 	_base = base;
-	_lon = base->getLongitude();
-	_lat = base->getLatitude();
+	_base->craftsChanged();
+	setLongitude(base->getLongitude());
+	setLatitude(base->getLatitude());
 }
 
 /**
  * Returns the current status of the craft.
- * @return Status string.
+ * @return Status.
  */
-std::string Craft::getStatus() const
+CraftStatus Craft::getStatus() const
 {
 	return _status;
 }
 
 /**
  * Changes the current status of the craft.
- * @param status Status string.
+ * The base is told so it can keep track of
+ * which crafts need maintenance.
+ * @param status Status.
+ */
+void Craft::setStatus(CraftStatus status)
+{
+	if (_status != status)
+	{
+		_status = status;
+		if (_base != 0)
+		{
+			_base->craftsChanged();
+		}
+	}
+}
+
+/**
+ * Returns the current status of the craft
+ * as a string, for displaying or saving.
+ * @return Status string.
  */
-void Craft::setStatus(const std::string &status)
+std::string Craft::getStatusString() const
 {
-	_status = status;
+	return statusStrings[_status];
 }
 
 /**
@@ -636,15 +668,15 @@ void Craft::checkup()
 
 	if (_damage > 0)
 	{
-		_status = "STR_REPAIRS";
+		setStatus(CRAFT_REPAIRS);
 	}
 	else if (available != full)
 	{
-		_status = "STR_REARMING";
+		setStatus(CRAFT_REARMING);
 	}
 	else
 	{
-		_status = "STR_REFUELLING";
+		setStatus(CRAFT_REFUELLING);
 	}
 }
 
@@ -680,7 +712,7 @@ void Craft::repair()
 	setDamage(_damage - _rules->getRepairRate());
 	if (_damage <= 0)
 	{
-		_status = "STR_REARMING";
+		setStatus(CRAFT_REARMING);
 	}
 }
 
@@ -693,12 +725,12 @@ void Craft::refuel()
 	setFuel(_fuel + _rules->getRefuelRate());
 	if (_fuel >= _rules->getMaxFuel())
 	{
-		_status = "STR_READY";
+		setStatus(CRAFT_READY);
 		for (std::vector<CraftWeapon*>::iterator i = _weapons.begin(); i != _weapons.end(); ++i)
 		{
 			if (*i && (*i)->isRearming())
 			{
-				_status = "STR_REARMING";
+				setStatus(CRAFT_REARMING);
 				break;
 			}
 		}
@@ -717,7 +749,7 @@ std::string Craft::rearm()
 	{
 		if (i == _weapons.end())
 		{
-			_status = "STR_REFUELLING";
+			setStatus(CRAFT_REFUELLING);
 			break;
 		}
 		if (*i != 0 && (*i)->isRearming())
@@ -35,6 +35,8 @@ class Ruleset;
 class SavedGame;
 class Vehicle;
 
+enum CraftStatus {CRAFT_READY, CRAFT_OUT, CRAFT_REPAIRS, CRAFT_REFUELLING, CRAFT_REARMING, CRAFT_STATUSES};
+
 /**
  * Represents a craft stored in a base.
  * Contains variable info about a craft like
@@ -50,7 +52,7 @@ private:
 	std::vector<CraftWeapon*> _weapons;
 	ItemContainer *_items;
 	std::vector<Vehicle*> _vehicles;
-	std::string _status;
+	CraftStatus _status;
 	bool _lowFuel;
 	bool _inBattlescape;
 	bool _inDogfight;
@@ -81,9 +83,11 @@ public:
 	/// Sets the craft's base.
 	void setBase(Base *base);
 	/// Gets the craft's status.
-	std::string getStatus() const;
+	CraftStatus getStatus() const;
 	/// Sets the craft's status.
-	void setStatus(const std::string &status);
+	void setStatus(CraftStatus status);
+	/// Gets the craft's status string.
+	std::string getStatusString() const;
 	/// Gets the craft's altitude.
 	std::string getAltitude() const;
 	/// Sets the craft's destination.
@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ItemContainer.h"
+#include <cmath>
 #include "../Ruleset/Ruleset.h"
 #include "../Ruleset/RuleItem.h"
 
@@ -26,7 +27,7 @@ namespace OpenXcom
 /**
  * Initializes an item container with no contents.
  */
-ItemContainer::ItemContainer() : _qty()
+ItemContainer::ItemContainer() : _qty(), _totalQuantity(0), _totalSize(0), _sizeRule(0)
 {
 }
 
@@ -44,6 +45,12 @@ ItemContainer::~ItemContainer()
 void ItemContainer::load(const YAML::Node &node)
 {
 	node >> _qty;
+	_totalQuantity = 0;
+	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
+	{
+		_totalQuantity += i->second;
+	}
+	_sizeRule = 0;
 }
 
 /**
@@ -66,11 +73,8 @@ void ItemContainer::addItem(const std::string &id, int qty)
 	{
 		return;
 	}
-	if (_qty.find(id) == _qty.end())
-	{
-		_qty[id] = 0;
-	}
 	_qty[id] += qty;
+	changeTotals(id, qty);
 }
 
 /**
@@ -80,17 +84,25 @@ void ItemContainer::addItem(const std::string &id, int qty)
  */
 void ItemContainer::removeItem(const std::string &id, int qty)
 {
-	if (id.empty() || _qty.find(id) == _qty.end())
+	if (id.empty())
+	{
+		return;
+	}
+	std::map<std::string, int>::iterator it = _qty.find(id);
+	if (it == _qty.end())
 	{
 		return;
 	}
-	if (qty < _qty[id])
+	if (qty < it->second)
 	{
-		_qty[id] -= qty;
+		changeTotals(id, -qty);
+		it->second -= qty;
 	}
 	else
 	{
-		_qty.erase(id);
+		// the ID could be the key that is about to be erased
+		changeTotals(id, -it->second);
+		_qty.erase(it);
 	}
 }
 
@@ -123,36 +135,71 @@ int ItemContainer::getItem(const std::string &id) const
  */
 int ItemContainer::getTotalQuantity() const
 {
-	int total = 0;
-	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
-	{
-		total += i->second;
-	}
-	return total;
+	return _totalQuantity;
 }
 
 /**
  * Returns the total size of the items in the container.
+ * The total is kept up to date as items are added and removed,
+ * so store screens can check it as often as they like and
+ * production, refuelling and rearming don't force a full recount.
  * @param rule Pointer to ruleset.
  * @return Total item size.
  */
 double ItemContainer::getTotalSize(const Ruleset *rule) const
 {
-	double total = 0;
-	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
+	if (_sizeRule != rule)
 	{
-		total += rule->getItem(i->first)->getSize() * i->second;
+		_totalSize = 0;
+		for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
+		{
+			_totalSize += getItemSize(rule, i->first) * i->second;
+		}
+		_sizeRule = rule;
 	}
-	return total;
+	return _totalSize / 100.0;
 }
 
 /**
  * Returns all the items currently contained within.
  * @return List of contents.
  */
-std::map<std::string, int> *ItemContainer::getContents()
+const std::map<std::string, int> *ItemContainer::getContents() const
 {
 	return &_qty;
 }
 
+/**
+ * Returns the size of an item in hundredths, so the total
+ * can be kept as an integer that doesn't drift as items
+ * are added and removed. Unknown items take up no space.
+ * @param rule Pointer to ruleset.
+ * @param id Item ID.
+ * @return Item size.
+ */
+int ItemContainer::getItemSize(const Ruleset *rule, const std::string &id)
+{
+	RuleItem *item = rule->getItem(id);
+	if (item == 0)
+	{
+		return 0;
+	}
+	return (int)floor(item->getSize() * 100 + 0.5);
+}
+
+/**
+ * Updates the totals after an item amount changes,
+ * so only that item's size has to be looked up.
+ * @param id Item ID.
+ * @param qty Quantity added (negative if removed).
+ */
+void ItemContainer::changeTotals(const std::string &id, int qty)
+{
+	_totalQuantity += qty;
+	if (_sizeRule != 0)
+	{
+		_totalSize += getItemSize(_sizeRule, id) * qty;
+	}
+}
+
 }
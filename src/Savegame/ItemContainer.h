@@ -37,6 +37,14 @@ class ItemContainer
 {
 private:
 	std::map<std::string, int> _qty;
+	int _totalQuantity;
+	mutable int _totalSize;
+	mutable const Ruleset *_sizeRule;
+
+	/// Gets the size of an item, in hundredths.
+	static int getItemSize(const Ruleset *rule, const std::string &id);
+	/// Updates the totals after an item amount changes.
+	void changeTotals(const std::string &id, int qty);
 public:
 	/// Creates an empty item container.
 	ItemContainer();
@@ -57,7 +65,7 @@ public:
 	/// Gets the total size of items in the container.
 	double getTotalSize(const Ruleset *rule) const;
 	/// Gets all the items in the container.
-	std::map<std::string, int> *getContents();
+	const std::map<std::string, int> *getContents() const;
 };
 
 }
@@ -135,8 +135,7 @@ void MovingTarget::calculateSpeed()
 	if (_dest != 0)
 	{
 		double dLon, dLat, length;
-		dLon = sin(_dest->getLongitude() - _lon) * cos(_dest->getLatitude());
-		dLat = cos(_lat) * sin(_dest->getLatitude()) - sin(_lat) * cos(_dest->getLatitude()) * cos(_dest->getLongitude() - _lon);
+		getHeading(_dest, &dLon, &dLat);
 		length = sqrt(dLon * dLon + dLat * dLat);
 		_speedLon = dLon / length * _speedRadian / cos(_lat + _speedLat);
 		_speedLat = dLat / length * _speedRadian;
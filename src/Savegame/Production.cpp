@@ -69,8 +69,9 @@ productionProgress_e Production::step(Base * b, SavedGame * g, const Ruleset *r)
 		if (_rules->getCategory() == "STR_CRAFT")
 		{
 			Craft *craft = new Craft(r->getCraft(_rules->getName()), b, g->getId(_rules->getName()));
-			craft->setStatus("STR_REFUELLING");
+			craft->setStatus(CRAFT_REFUELLING);
 			b->getCrafts()->push_back(craft);
+			b->craftsChanged();
 		}
 		else
 		{
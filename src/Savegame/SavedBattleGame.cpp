@@ -21,6 +21,8 @@
 #include "SavedGame.h"
 #include "Tile.h"
 #include "Node.h"
+#include <cstring>
+#include <algorithm>
 #include <SDL.h>
 #include "../Ruleset/MapDataSet.h"
 #include "../Battlescape/Pathfinding.h"
@@ -35,15 +37,19 @@
 #include "../Battlescape/AggroBAIState.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
+#include "../Engine/Exception.h"
 
 
 namespace OpenXcom
 {
 
+/// Version of the binary tile data written to saves.
+static const int TILE_DATA_VERSION = 1;
+
 /**
  * Initializes a brand new battlescape saved game.
  */
-SavedBattleGame::SavedBattleGame() : _width(0), _length(0), _height(0), _tiles(), _selectedUnit(0), _lastSelectedUnit(0), _nodes(), _units(), _items(), _pathfinding(0), _tileEngine(0), _missionType(""), _globalShade(0), _side(FACTION_PLAYER), _turn(1), _debugMode(false), _aborted(false), _itemId(0), _objectiveDestroyed(false), _fallingUnits(), _unitsFalling(false)
+SavedBattleGame::SavedBattleGame() : _width(0), _length(0), _height(0), _tiles(), _selectedUnit(0), _lastSelectedUnit(0), _nodes(), _units(), _items(), _pathfinding(0), _tileEngine(0), _missionType(""), _globalShade(0), _side(FACTION_PLAYER), _turn(1), _debugMode(false), _aborted(false), _itemId(0), _objectiveDestroyed(false), _fallingUnits(), _terrainChangesStart(0), _unitsFalling(false)
 {
 	std::string temp;
 	temp = Options::getString("battleScrollButton");
@@ -61,10 +67,6 @@ SavedBattleGame::SavedBattleGame() : _width(0), _length(0), _height(0), _tiles()
  */
 SavedBattleGame::~SavedBattleGame()
 {
-	for (int i = 0; i < _height * _length * _width; ++i)
-	{
-		delete _tiles[i];
-	}
 	delete[] _tiles;
 
 	for (std::vector<Node*>::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
@@ -113,25 +115,59 @@ void SavedBattleGame::load(const YAML::Node &node, Ruleset *rule, SavedGame* sav
 
 	initMap(_width, _length, _height);
 
-	for (YAML::Iterator i = node["tiles"].begin(); i != node["tiles"].end(); ++i)
+	if (const YAML::Node *pName = node.FindValue("tileData"))
 	{
-		Position pos;
-		(*i)["position"][0] >> pos.x;
-		(*i)["position"][1] >> pos.y;
-		(*i)["position"][2] >> pos.z;
-		getTile(pos)->load((*i));
+		int version;
+		node["tileDataVersion"] >> version;
+		if (version != TILE_DATA_VERSION)
+		{
+			throw Exception("Unsupported battlescape tile data version");
+		}
+		YAML::Binary binary;
+		*pName >> binary;
+		std::vector<unsigned char> tileData;
+		binary.swap(tileData);
+		// runs of identical tiles: 16 bit count followed by one tile record
+		const size_t runSize = 2 + Tile::BINARY_RECORD_SIZE;
+		int index = 0;
+		int size = _height * _length * _width;
+		if (tileData.size() % runSize != 0)
+		{
+			throw Exception("Invalid battlescape tile data");
+		}
+		for (size_t ptr = 0; ptr < tileData.size(); ptr += runSize)
+		{
+			int count = tileData[ptr] | (tileData[ptr + 1] << 8);
+			if (index + count > size)
+			{
+				throw Exception("Invalid battlescape tile data");
+			}
+			for (int j = 0; j < count; ++j, ++index)
+			{
+				_tiles[index]->loadBinary(&tileData[ptr + 2]);
+			}
+		}
+		// the runs have to cover the whole map, a short blob would leave tiles empty
+		if (index != size)
+		{
+			throw Exception("Invalid battlescape tile data");
+		}
+	}
+	else
+	{
+		for (YAML::Iterator i = node["tiles"].begin(); i != node["tiles"].end(); ++i)
+		{
+			Position pos;
+			(*i)["position"][0] >> pos.x;
+			(*i)["position"][1] >> pos.y;
+			(*i)["position"][2] >> pos.z;
+			getTile(pos)->load((*i));
+		}
 	}
-/*	const int recordSize = 19;
-	std::string s;
-	node["tiles"] >> s;
-	std::vector<unsigned char> tileData( s.begin(), s.end() );
-	int records = tileData.size() / recordSize;
-	for (int i = 0; i < records; ++i)
+	for (int i = 0; i < _height * _length * _width; ++i)
 	{
-		int index = tileData.data()[(i * recordSize)] + tileData.data()[(i * recordSize)+1] << 8 + tileData.data()[(i * recordSize)+2] << 16 + tileData.data()[(i * recordSize)+3] << 24;
-		_tiles[index]->loadBinary(&tileData.data()[(i * recordSize)]);
+		trackFireAndSmoke(_tiles[i]);
 	}
-*/
 
 	for (YAML::Iterator i = node["nodes"].begin(); i != node["nodes"].end(); ++i)
 	{
@@ -290,10 +326,7 @@ void SavedBattleGame::loadMapResources(ResourcePack *res)
 	getTileEngine()->calculateSunShading();
 	getTileEngine()->calculateTerrainLighting();
 	getTileEngine()->calculateUnitLighting();
-	for (std::vector<BattleUnit*>::iterator bu = _units.begin(); bu != _units.end(); ++bu)
-	{
-		_tileEngine->calculateFOV(*bu);
-	}
+	getTileEngine()->calculateFOV(_units);
 }
 
 /**
@@ -319,37 +352,31 @@ void SavedBattleGame::save(YAML::Emitter &out) const
 		out << (*i)->getName();
 	}
 	out << YAML::EndSeq;
-	out << YAML::Key << "tiles" << YAML::Value;
-	out << YAML::BeginSeq;
-	for (int i = 0; i < _height * _length * _width; ++i)
-	{
-		if (!_tiles[i]->isVoid())
-		{
-			_tiles[i]->save(out);
-		}
-	}
-	out << YAML::EndSeq;
-	/*const int recordSize = 19;
-	size_t tileDataSize = recordSize * _height * _length * _width;
-	unsigned char* tileData = (unsigned char*) malloc(tileDataSize);
-	int ptr = 0;
+	// tiles are stored as runs of identical binary records, which packs the empty sky and repeated floors
+	std::vector<unsigned char> tileData;
+	unsigned char record[Tile::BINARY_RECORD_SIZE], last[Tile::BINARY_RECORD_SIZE];
+	size_t countPtr = 0;
 	for (int i = 0; i < _height * _length * _width; ++i)
 	{
-		if (!_tiles[i]->isVoid())
+		_tiles[i]->saveBinary(record);
+		int count = i ? tileData[countPtr] | (tileData[countPtr + 1] << 8) : 0;
+		if (i && count < 0xFFFF && memcmp(record, last, Tile::BINARY_RECORD_SIZE) == 0)
 		{
-			tileData[ptr] = (unsigned int)i;
-			_tiles[i]->saveBinary(&tileData[ptr]);
-			ptr += recordSize;
+			++count;
+			tileData[countPtr] = count & 0xFF;
+			tileData[countPtr + 1] = (count >> 8) & 0xFF;
 		}
 		else
 		{
-			tileDataSize -= recordSize;
+			countPtr = tileData.size();
+			tileData.push_back(1);
+			tileData.push_back(0);
+			tileData.insert(tileData.end(), record, record + Tile::BINARY_RECORD_SIZE);
+			memcpy(last, record, Tile::BINARY_RECORD_SIZE);
 		}
 	}
-	out << YAML::Key << "tiles" << YAML::Value << YAML::Binary(tileData, tileDataSize);
-    free(tileData);
-    ptr = NULL;
-	*/
+	out << YAML::Key << "tileDataVersion" << YAML::Value << TILE_DATA_VERSION;
+	out << YAML::Key << "tileData" << YAML::Value << YAML::Binary(tileData.empty() ? 0 : &tileData[0], tileData.size());
 	out << YAML::Key << "nodes" << YAML::Value;
 	out << YAML::BeginSeq;
 	for (std::vector<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
@@ -396,10 +423,6 @@ void SavedBattleGame::initMap(int width, int length, int height)
 {
 	if (!_nodes.empty())
 	{
-		for (int i = 0; i < _height * _length * _width; ++i)
-		{
-			delete _tiles[i];
-		}
 		delete[] _tiles;
 
 		for (std::vector<Node*>::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
@@ -413,14 +436,21 @@ void SavedBattleGame::initMap(int width, int length, int height)
 	_width = width;
 	_length = length;
 	_height = height;
+	/* create tile objects, all in one block so sweeps over the map stay in order in memory */
+	_tileStorage.clear();
+	_tileStorage.reserve(_height * _length * _width);
 	_tiles = new Tile*[_height * _length * _width];
-	/* create tile objects */
 	for (int i = 0; i < _height * _length * _width; ++i)
 	{
 		Position pos;
 		getTileCoords(i, &pos.x, &pos.y, &pos.z);
-		_tiles[i] = new Tile(pos);
+		_tileStorage.push_back(Tile(pos, this));
+		_tiles[i] = &_tileStorage[i];
 	}
+	_fireSmokeTiles.clear();
+	_fireSmokeTracked.assign(_height * _length * _width, false);
+	_terrainChanges.clear();
+	_terrainChangesStart = 0;
 
 }
 
@@ -430,6 +460,9 @@ void SavedBattleGame::initMap(int width, int length, int height)
  */
 void SavedBattleGame::initUtilities(ResourcePack *res)
 {
+	// the utilities keep per-tile data, so they are rebuilt every time the map is initialized
+	delete _pathfinding;
+	delete _tileEngine;
 	_pathfinding = new Pathfinding(this);
 	_tileEngine = new TileEngine(this, res->getVoxelData());
 }
@@ -998,7 +1031,7 @@ Node *SavedBattleGame::getSpawnNode(int nodeRank, BattleUnit *unit)
 	
 	if (compliantNodes.empty()) return 0;
 
-	int n = RNG::generate(0, compliantNodes.size() - 1);
+	int n = RNG::generate(RNG::BATTLESCAPE, 0, compliantNodes.size() - 1);
 
 	return compliantNodes[n];
 }
@@ -1034,7 +1067,7 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 
 	if (compliantNodes.empty()) return 0;
 
-	return compliantNodes[RNG::generate(0, compliantNodes.size() - 1)];
+	return compliantNodes[RNG::generate(RNG::BATTLESCAPE, 0, compliantNodes.size() - 1)];
 }
 
 /**
@@ -1045,23 +1078,25 @@ void SavedBattleGame::prepareNewTurn()
 {
 	std::vector<Tile*> tilesOnFire;
 	std::vector<Tile*> tilesOnSmoke;
+	std::vector<Tile*> tilesIgnited;
 
-	// prepare a list of tiles on fire/smoke
-	for (int i = 0; i < getWidth() * getLength() * getHeight(); ++i)
+	// prepare a list of tiles on fire/smoke, in map order
+	std::sort(_fireSmokeTiles.begin(), _fireSmokeTiles.end());
+	for (std::vector<int>::const_iterator i = _fireSmokeTiles.begin(); i != _fireSmokeTiles.end(); ++i)
 	{
-		if (getTiles()[i]->getFire() > 0)
+		if (_tiles[*i]->getFire() > 0)
 		{
-			tilesOnFire.push_back(getTiles()[i]);
+			tilesOnFire.push_back(_tiles[*i]);
 		}
-		if (getTiles()[i]->getSmoke() > 0)
+		if (_tiles[*i]->getSmoke() > 0)
 		{
-			tilesOnSmoke.push_back(getTiles()[i]);
+			tilesOnSmoke.push_back(_tiles[*i]);
 		}
 	}
 
 	// smoke spreads in 1 random direction, but the direction is same for all smoke
-	int spreadX = RNG::generate(-1, +1);
-	int spreadY = RNG::generate(-1, +1);
+	int spreadX = RNG::generate(RNG::BATTLESCAPE, -1, +1);
+	int spreadY = RNG::generate(RNG::BATTLESCAPE, -1, +1);
 	for (std::vector<Tile*>::iterator i = tilesOnSmoke.begin(); i != tilesOnSmoke.end(); ++i)
 	{
 		int x = (*i)->getPosition().x;
@@ -1078,11 +1113,13 @@ void SavedBattleGame::prepareNewTurn()
 		if (t && !t->getSmoke() && getTileEngine()->horizontalBlockage((*i), t, DT_SMOKE) == 0)
 		{
 			t->addSmoke((*i)->getSmoke()/2);
+			trackFireAndSmoke(t);
 		}
 		Tile *t2 = getTile(Position(x+spreadX+spreadX, y+spreadY+spreadY, z));
 		if (t && t2 && !t2->getSmoke() && getTileEngine()->horizontalBlockage(t, t2, DT_SMOKE) == 0)
 		{
 			t2->addSmoke((*i)->getSmoke()/4);
+			trackFireAndSmoke(t2);
 		}
 
 		// smoke also spreads upwards
@@ -1090,6 +1127,7 @@ void SavedBattleGame::prepareNewTurn()
 		if (t && !t->getSmoke() && getTileEngine()->verticalBlockage((*i), t, DT_SMOKE) == 0)
 		{
 			t->addSmoke((*i)->getSmoke()/2);
+			trackFireAndSmoke(t);
 		}
 
 		(*i)->prepareNewTurn();
@@ -1100,11 +1138,11 @@ void SavedBattleGame::prepareNewTurn()
 		if ((*i)->getUnit())
 		{
 			// units on a flaming tile suffer damage
-			(*i)->getUnit()->damage(Position(0,0,0), RNG::generate(1,12), DT_IN, true);
+			(*i)->getUnit()->damage(Position(0,0,0), RNG::generate(RNG::BATTLESCAPE, 1,12), DT_IN, true);
 			// units on a flaming tile can catch fire 33% chance
-			if (RNG::generate(0,2) == 1)
+			if (RNG::generate(RNG::BATTLESCAPE, 0,2) == 1)
 			{
-				(*i)->getUnit()->setFire(RNG::generate(1,5));
+				(*i)->getUnit()->setFire(RNG::generate(RNG::BATTLESCAPE, 1,5));
 			}
 		}
 
@@ -1122,14 +1160,16 @@ void SavedBattleGame::prepareNewTurn()
 						int flam = t->getFlammability();
 						if (flam < 255)
 						{
-							double base = RNG::boxMuller(0,126);
+							double base = RNG::boxMuller(RNG::BATTLESCAPE, 0,126);
 							if (base < 0) base *= -1;
 
 							if (flam < base)
 							{
-								if (RNG::generate(0, flam) < 2)
+								if (RNG::generate(RNG::BATTLESCAPE, 0, flam) < 2)
 								{
 									t->ignite();
+									trackFireAndSmoke(t);
+									tilesIgnited.push_back(t);
 								}
 							}
 						}
@@ -1141,15 +1181,92 @@ void SavedBattleGame::prepareNewTurn()
 			_objectiveDestroyed = (*i)->prepareNewTurn();
 	}
 
+	// forget about the tiles that stopped burning and smoking
+	std::vector<int>::iterator last = _fireSmokeTiles.begin();
+	for (std::vector<int>::iterator i = _fireSmokeTiles.begin(); i != _fireSmokeTiles.end(); ++i)
+	{
+		if (_tiles[*i]->getFire() == 0 && _tiles[*i]->getSmoke() == 0)
+		{
+			_fireSmokeTracked[*i] = false;
+		}
+		else
+		{
+			*last++ = *i;
+		}
+	}
+	_fireSmokeTiles.erase(last, _fireSmokeTiles.end());
+
 	if (!tilesOnFire.empty())
 	{
-		getTileEngine()->calculateTerrainLighting(); // fires could have been stopped
+		tilesIgnited.insert(tilesIgnited.end(), tilesOnFire.begin(), tilesOnFire.end());
+		getTileEngine()->calculateTerrainLighting(tilesIgnited); // fires could have been stopped
 	}
 
 	reviveUnconsciousUnits();
 
 }
 
+/**
+ * Adds a tile to the list of tiles on fire or smoking, if it is
+ * and isn't in there yet. Must be called whenever a tile could have
+ * caught fire or smoke, so the new turn only needs to go through these.
+ * @param tile Pointer to the tile.
+ */
+void SavedBattleGame::trackFireAndSmoke(Tile *tile)
+{
+	if (tile->getFire() == 0 && tile->getSmoke() == 0)
+		return;
+	int index = getTileIndex(tile->getPosition());
+	if (!_fireSmokeTracked[index])
+	{
+		_fireSmokeTracked[index] = true;
+		_fireSmokeTiles.push_back(index);
+	}
+}
+
+/**
+ * Adds a tile to the log of terrain changes (destroyed parts, opened or closed doors).
+ * Caches of terrain data read the log instead of checking every tile of the map.
+ * When the log grows too long, it's emptied, and readers that are behind
+ * have to assume every tile changed.
+ * @param tile Pointer to the tile.
+ */
+void SavedBattleGame::terrainChanged(Tile *tile)
+{
+	if (_terrainChanges.size() >= MAX_TERRAIN_CHANGES)
+	{
+		_terrainChangesStart += _terrainChanges.size();
+		_terrainChanges.clear();
+	}
+	_terrainChanges.push_back(tile->getPosition());
+}
+
+/**
+ * Gets the number of terrain changes recorded so far.
+ * Readers of the log start from this to skip the changes made before they existed.
+ * @return Number of changes.
+ */
+int SavedBattleGame::getTerrainChangeCount() const
+{
+	return _terrainChangesStart + _terrainChanges.size();
+}
+
+/**
+ * Gets the positions of the tiles whose terrain changed since an earlier point of the log.
+ * @param since Pointer to the change count the reader got to last time, updated to the current count.
+ * @param changes Pointer to the list the changed positions are added to. A tile can be in there more than once.
+ * @return False if the log doesn't go back that far, so any tile may have changed.
+ */
+bool SavedBattleGame::getTerrainChanges(int *since, std::vector<Position> *changes) const
+{
+	int first = *since;
+	*since = getTerrainChangeCount();
+	if (first < _terrainChangesStart)
+		return false;
+	changes->insert(changes->end(), _terrainChanges.begin() + (first - _terrainChangesStart), _terrainChanges.end());
+	return true;
+}
+
 /**
  * Units that are unconscious but shouldn't are revived, they need a tile to stand on. The unit's current position could be occupied.
  * We will search in all directions for a free tile, if not found, the unit stays unconscious...
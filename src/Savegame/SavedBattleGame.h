@@ -26,11 +26,11 @@
 #include <yaml-cpp/yaml.h>
 #include "BattleItem.h"
 #include "BattleUnit.h"
+#include "Tile.h"
 
 namespace OpenXcom
 {
 
-class Tile;
 class SavedGame;
 class MapDataSet;
 class RuleUnit;
@@ -55,8 +55,10 @@ class Ruleset;
 class SavedBattleGame
 {
 private:
+	static const size_t MAX_TERRAIN_CHANGES = 4096;
 	int _width, _length, _height;
 	std::vector<MapDataSet*> _mapDataSets;
+	std::vector<Tile> _tileStorage;
 	Tile **_tiles;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
@@ -78,6 +80,10 @@ private:
 	bool _objectiveDestroyed;
 	std::vector<BattleUnit*> _exposedUnits;
 	std::vector<BattleUnit*> _fallingUnits;
+	std::vector<int> _fireSmokeTiles;
+	std::vector<bool> _fireSmokeTracked;
+	std::vector<Position> _terrainChanges;
+	int _terrainChangesStart;
 	bool _unitsFalling;
 public:
 	/// Creates a new battle save, based on current generic save.
@@ -172,6 +178,14 @@ public:
 	Node *getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode);
 	/// New turn preparations.
 	void prepareNewTurn();
+	/// Keeps track of a tile if it's on fire or smoking.
+	void trackFireAndSmoke(Tile *tile);
+	/// Records that the terrain of a tile changed.
+	void terrainChanged(Tile *tile);
+	/// Gets the number of terrain changes recorded so far.
+	int getTerrainChangeCount() const;
+	/// Gets the tiles whose terrain changed since an earlier point of the change log.
+	bool getTerrainChanges(int *since, std::vector<Position> *changes) const;
 	/// Revive unconscious units (healthcheck).
 	void reviveUnconsciousUnits();
 	/// Remove the body item that corresponds to the unit
@@ -25,6 +25,7 @@
 #include "../Engine/Logger.h"
 #include "../Ruleset/Ruleset.h"
 #include "../Engine/RNG.h"
+#include "../Engine/BackgroundWriter.h"
 #include "../Engine/Language.h"
 #include "../Interface/TextList.h"
 #include "../Engine/Exception.h"
@@ -49,18 +50,19 @@
 #include "AlienStrategy.h"
 #include "AlienMission.h"
 #include "../Ruleset/RuleRegion.h"
+#include "../Ruleset/RuleCountry.h"
 
 namespace OpenXcom
 {
 struct findRuleResearch : public std::unary_function<ResearchProject *,
 								bool>
 {
-	RuleResearch * _toFind;
-	findRuleResearch(RuleResearch * toFind);
+	const RuleResearch * _toFind;
+	findRuleResearch(const RuleResearch * toFind);
 	bool operator()(const ResearchProject *r) const;
 };
 
-findRuleResearch::findRuleResearch(RuleResearch * toFind) : _toFind(toFind)
+findRuleResearch::findRuleResearch(const RuleResearch * toFind) : _toFind(toFind)
 {
 }
 
@@ -137,33 +139,172 @@ SavedGame::~SavedGame()
 	delete _battleGame;
 }
 
+/**
+ * Brief info on a save file, as kept in the save index.
+ */
+struct SaveIndexEntry
+{
+	int size, difficulty;
+	long modified;
+	GameTime time;
+	SaveIndexEntry() : size(-1), difficulty(0), modified(-1), time(6, 1, 1, 1999, 12, 0, 0) {}
+};
+
+/**
+ * Gets the path of the save index in the user folder.
+ * @return Full path.
+ */
+static std::string getIndexFile()
+{
+	return Options::getUserFolder() + "saves.idx";
+}
+
+/**
+ * Gets the size of a file without reading it.
+ * @param path Full path of the file.
+ * @return Size in bytes, -1 if the file can't be opened.
+ */
+static int getFileSize(const std::string &path)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		return -1;
+	return (int)file.tellg();
+}
+
+/**
+ * Loads the save index, which holds the brief info of every save
+ * so the saves list doesn't have to open them.
+ * @param index Pointer to the map of entries by file name.
+ */
+static void loadIndex(std::map<std::string, SaveIndexEntry> *index)
+{
+	std::ifstream fin(getIndexFile().c_str());
+	if (!fin)
+		return;
+	try
+	{
+		YAML::Parser parser(fin);
+		YAML::Node doc;
+		parser.GetNextDocument(doc);
+		for (YAML::Iterator i = doc.begin(); i != doc.end(); ++i)
+		{
+			std::string file;
+			SaveIndexEntry entry;
+			(*i)["file"] >> file;
+			(*i)["size"] >> entry.size;
+			if (const YAML::Node *pModified = (*i).FindValue("modified"))
+			{
+				*pModified >> entry.modified;
+			}
+			(*i)["difficulty"] >> entry.difficulty;
+			entry.time.load((*i)["time"]);
+			(*index)[file] = entry;
+		}
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_WARNING) << "Ignoring save index: " << e.what();
+		index->clear();
+	}
+}
+
+/**
+ * Saves the save index. It is written to a temporary file first
+ * and then moved over the old one, so a crash can't leave it half written.
+ * @param index Map of entries by file name.
+ */
+static void saveIndex(const std::map<std::string, SaveIndexEntry> &index)
+{
+	YAML::Emitter out;
+	out << YAML::BeginSeq;
+	for (std::map<std::string, SaveIndexEntry>::const_iterator i = index.begin(); i != index.end(); ++i)
+	{
+		out << YAML::BeginMap;
+		out << YAML::Key << "file" << YAML::Value << i->first;
+		out << YAML::Key << "size" << YAML::Value << i->second.size;
+		out << YAML::Key << "modified" << YAML::Value << i->second.modified;
+		out << YAML::Key << "difficulty" << YAML::Value << i->second.difficulty;
+		out << YAML::Key << "time" << YAML::Value;
+		i->second.time.save(out);
+		out << YAML::EndMap;
+	}
+	out << YAML::EndSeq;
+	std::string temp = getIndexFile() + ".tmp";
+	{
+		std::ofstream fout(temp.c_str());
+		if (fout)
+		{
+			fout << out.c_str();
+			fout.close();
+		}
+		if (!fout)
+		{
+			Log(LOG_WARNING) << "Failed to save " << getIndexFile();
+			CrossPlatform::deleteFile(temp);
+			return;
+		}
+	}
+	if (!CrossPlatform::moveFile(temp, getIndexFile()))
+	{
+		Log(LOG_WARNING) << "Failed to replace " << getIndexFile();
+		CrossPlatform::deleteFile(temp);
+	}
+}
+
 /**
  * Gets all the saves found in the user folder
- * and adds them to a text list.
+ * and adds them to a text list. The info comes from the save
+ * index when its entry matches the file size and modification time,
+ * otherwise the file's header is read and the index updated.
  * @param list Text list.
  * @param lang Loaded language.
  */
 void SavedGame::getList(TextList *list, Language *lang)
 {
 	std::vector<std::string> saves = CrossPlatform::getFolderContents(Options::getUserFolder(), "sav");
+	std::map<std::string, SaveIndexEntry> index, current;
+	loadIndex(&index);
+	bool changed = false;
 
 	for (std::vector<std::string>::iterator i = saves.begin(); i != saves.end(); ++i)
 	{
 		std::string file = (*i);
 		std::string fullname = Options::getUserFolder() + file;
-		std::ifstream fin(fullname.c_str());
 		try
 		{
-			if (!fin)
+			SaveIndexEntry entry;
+			int size = getFileSize(fullname);
+			long modified = (long)CrossPlatform::getDateModified(fullname);
+			std::map<std::string, SaveIndexEntry>::const_iterator indexed = index.find(file);
+			if (size != -1 && indexed != index.end() && indexed->second.size == size && indexed->second.modified == modified)
 			{
-				throw Exception("Failed to load " + file);
+				entry = indexed->second;
 			}
-			YAML::Parser parser(fin);
-			YAML::Node doc;
+			else
+			{
+				std::ifstream fin(fullname.c_str());
+				if (!fin)
+				{
+					throw Exception("Failed to load " + file);
+				}
+				YAML::Parser parser(fin);
+				YAML::Node doc;
+
+				parser.GetNextDocument(doc);
+				entry.size = size;
+				entry.modified = modified;
+				entry.time.load(doc["time"]);
+				if (const YAML::Node *pName = doc.FindValue("difficulty"))
+				{
+					*pName >> entry.difficulty;
+				}
+				fin.close();
+				changed = true;
+			}
+			current[file] = entry;
 
-			parser.GetNextDocument(doc);
-			GameTime time = GameTime(6, 1, 1, 1999, 12, 0, 0);
-			time.load(doc["time"]);
+			const GameTime &time = entry.time;
 			std::stringstream saveTime;
 			std::wstringstream saveDay, saveMonth, saveYear;
 			saveTime << time.getHour() << ":" << std::setfill('0') << std::setw(2) << time.getMinute();
@@ -178,7 +319,6 @@ void SavedGame::getList(TextList *list, Language *lang)
 			std::wstring wstr = Language::utf8ToWstr(s);
 #endif
 			list->addRow(5, wstr.c_str(), Language::utf8ToWstr(saveTime.str()).c_str(), saveDay.str().c_str(), saveMonth.str().c_str(), saveYear.str().c_str());
-			fin.close();
 		}
 		catch (Exception &e)
 		{
@@ -191,6 +331,12 @@ void SavedGame::getList(TextList *list, Language *lang)
 			continue;
 		}
 	}
+
+	// drop deleted saves from the index too
+	if (changed || current.size() != index.size())
+	{
+		saveIndex(current);
+	}
 }
 
 /**
@@ -253,6 +399,7 @@ void SavedGame::load(const std::string &filename, Ruleset *rule)
 		r->load(*i);
 		_regions.push_back(r);
 	}
+	indexZones();
 
 	// Alien bases must be loaded before alien missions
 	for (YAML::Iterator i = doc["alienBases"].begin(); i != doc["alienBases"].end(); ++i)
@@ -308,7 +455,13 @@ void SavedGame::load(const std::string &filename, Ruleset *rule)
 	{
 		std::string research;
 		*it >> research;
-		_discovered.push_back(rule->getResearch(research));
+		RuleResearch *r = rule->getResearch(research);
+		if (r == 0)
+		{
+			Log(LOG_WARNING) << "Skipping unknown research: " << research;
+			continue;
+		}
+		setDiscovered(r);
 	}
 
 	_alienStrategy->load(rule, doc["alienStrategy"]);
@@ -328,20 +481,68 @@ void SavedGame::load(const std::string &filename, Ruleset *rule)
  */
 void SavedGame::save(const std::string &filename) const
 {
-	std::string s = Options::getUserFolder() + filename + ".sav";
-	std::ofstream sav(s.c_str());
-	if (!sav)
+	BackgroundWriter *writer = saveBackground(filename);
+	bool success = writer->wait();
+	std::string error = writer->getError();
+	delete writer;
+	if (!success)
 	{
-		throw Exception("Failed to save " + filename + ".sav");
+		throw Exception(error);
 	}
+	indexSave(filename);
+}
 
+/**
+ * Saves a saved game's contents to a YAML file, writing the file in the background.
+ * Only the disk I/O is done on the writer thread: the YAML document is built here,
+ * on the calling thread, since the emitter reads the live game objects.
+ * The save index is left alone, the caller updates it with indexSave() once the write succeeded.
+ * @param filename YAML filename.
+ * @return Pointer to the writer, to be checked and deleted by the caller.
+ */
+BackgroundWriter *SavedGame::saveBackground(const std::string &filename) const
+{
+	std::string s = Options::getUserFolder() + filename + ".sav";
 	YAML::Emitter out;
+	save(out);
+	return new BackgroundWriter(s, out.c_str(), out.size());
+}
 
+/**
+ * Adds a save file to the save index, with the brief info of this game.
+ * Must only be called once the file has been written successfully,
+ * so the index never describes a save that isn't there.
+ * @param filename YAML filename.
+ */
+void SavedGame::indexSave(const std::string &filename) const
+{
+	std::string s = Options::getUserFolder() + filename + ".sav";
+	int size = getFileSize(s);
+	if (size == -1)
+		return;
+	std::map<std::string, SaveIndexEntry> index;
+	loadIndex(&index);
+	SaveIndexEntry &entry = index[filename + ".sav"];
+	entry.size = size;
+	entry.modified = (long)CrossPlatform::getDateModified(s);
+	entry.difficulty = _difficulty;
+	entry.time = *_time;
+	saveIndex(index);
+}
+
+/**
+ * Saves a saved game's contents to a YAML emitter,
+ * the brief game info followed by the full game data.
+ * @param out YAML emitter.
+ */
+void SavedGame::save(YAML::Emitter &out) const
+{
 	// Saves the brief game info used in the saves list
 	out << YAML::BeginMap;
 	out << YAML::Key << "version" << YAML::Value << Options::getVersion();
 	out << YAML::Key << "time" << YAML::Value;
 	_time->save(out);
+	out << YAML::Key << "difficulty" << YAML::Value << _difficulty;
 	out << YAML::EndMap;
 
 	// Saves the full game data to the save
@@ -432,8 +633,6 @@ void SavedGame::save(const std::string &filename) const
 		_battleGame->save(out);
 	}
 	out << YAML::EndMap;
-	sav << out.c_str();
-	sav.close();
 }
 
 /**
@@ -703,10 +902,9 @@ void SavedGame::setBattleGame(SavedBattleGame *battleGame)
 */
 void SavedGame::addFinishedResearch (const RuleResearch * r, const Ruleset * ruleset)
 {
-	std::vector<const RuleResearch *>::const_iterator itDiscovered = std::find(_discovered.begin (), _discovered.end (), r);
-	if(itDiscovered == _discovered.end())
+	if(!isDiscovered(r))
 	{
-		_discovered.push_back(r);
+		setDiscovered(r);
 		addResearchScore(r->getPoints());
 	}
 	if(ruleset)
@@ -755,52 +953,14 @@ const std::vector<const RuleResearch *> & SavedGame::getDiscoveredResearch() con
 */
 void SavedGame::getAvailableResearchProjects (std::vector<RuleResearch *> & projects, const Ruleset * ruleset, Base * base) const
 {
-	const std::vector<const RuleResearch *> & discovered(getDiscoveredResearch());
-	std::vector<std::string> researchProjects = ruleset->getResearchList();
-	const std::vector<ResearchProject *> & baseResearchProjects = base->getResearch();
-	std::vector<const RuleResearch *> unlocked;
-	for(std::vector<const RuleResearch *>::const_iterator it = discovered.begin (); it != discovered.end (); ++it)
-	{
-		for(std::vector<std::string>::const_iterator itUnlocked = (*it)->getUnlocked ().begin (); itUnlocked != (*it)->getUnlocked ().end (); ++itUnlocked)
-		{
-			unlocked.push_back(ruleset->getResearch(*itUnlocked));
-		}
-	}
+	const std::vector<std::string> & researchProjects = ruleset->getResearchList();
 	for(std::vector<std::string>::const_iterator iter = researchProjects.begin (); iter != researchProjects.end (); ++iter)
 	{
 		RuleResearch *research = ruleset->getResearch(*iter);
-		if (!isResearchAvailable(research, unlocked, ruleset))
+		if (isResearchAvailable(research, base))
 		{
-			continue;
+			projects.push_back (research);
 		}
-		std::vector<const RuleResearch *>::const_iterator itDiscovered = std::find(discovered.begin (), discovered.end (), research);
-		if (itDiscovered != discovered.end () && research->getStringTemplate().size() == 0)
-		{
-			continue;
-		}
-		if (std::find_if (baseResearchProjects.begin(), baseResearchProjects.end (), findRuleResearch(research)) != baseResearchProjects.end ())
-		{
-			continue;
-		}
-		if (research->needItem() && base->getItems()->getItem(research->getName ()) == 0)
-		{
-			continue;
-		}
-		if (research->getRequirements().size() != 0)
-		{
-			size_t tally(0);
-			for(size_t itreq = 0; itreq != research->getRequirements().size(); ++itreq)
-			{
-				itDiscovered = std::find(discovered.begin (), discovered.end (), ruleset->getResearch(research->getRequirements().at(itreq)));
-				if (itDiscovered != discovered.end ())
-				{
-					tally++;
-				}
-			}
-			if(tally != research->getRequirements().size())
-			continue;
-		}
-		projects.push_back (research);
 	}
 }
 
@@ -833,30 +993,81 @@ void SavedGame::getAvailableProductions (std::vector<RuleManufacture *> & produc
 }
 
 /**
-   Check whether a ResearchProject can be researched.
+   Check whether a ResearchProject has been discovered.
    * @param r the RuleResearch to test.
-   * @param unlocked the list of currently unlocked RuleResearch
+   * @return true if the RuleResearch has been discovered
+*/
+bool SavedGame::isDiscovered (const RuleResearch * r) const
+{
+	return r != 0 && r->getIndex() >= 0 && (size_t)r->getIndex() < _discoveredFlags.size() && _discoveredFlags[r->getIndex()];
+}
+
+/**
+   Add a ResearchProject to the discovered list, and unlock
+   any ResearchProject it unlocks.
+   * @param r the RuleResearch discovered.
+*/
+void SavedGame::setDiscovered (const RuleResearch * r)
+{
+	_discovered.push_back(r);
+	if (r->getIndex() < 0)
+	{
+		return;
+	}
+	if ((size_t)r->getIndex() >= _discoveredFlags.size())
+	{
+		_discoveredFlags.resize(r->getIndex() + 1, false);
+	}
+	_discoveredFlags[r->getIndex()] = true;
+	for(std::vector<const RuleResearch *>::const_iterator iter = r->getUnlockRules().begin (); iter != r->getUnlockRules().end (); ++iter)
+	{
+		if ((size_t)(*iter)->getIndex() >= _unlockedFlags.size())
+		{
+			_unlockedFlags.resize((*iter)->getIndex() + 1, false);
+		}
+		_unlockedFlags[(*iter)->getIndex()] = true;
+	}
+}
+
+/**
+   Check whether a ResearchProject can be researched in a Base.
+   * @param r the RuleResearch to test.
+   * @param base a pointer to a Base
    * @return true if the RuleResearch can be researched
 */
-bool SavedGame::isResearchAvailable (RuleResearch * r, const std::vector<const RuleResearch *> & unlocked, const Ruleset * ruleset) const
+bool SavedGame::isResearchAvailable (const RuleResearch * r, Base * base) const
 {
-	std::vector<std::string> deps = r->getDependencies();
-	const std::vector<const RuleResearch *> & discovered(getDiscoveredResearch());
-	if(std::find(unlocked.begin (), unlocked.end (),
-			 r) != unlocked.end ())
+	// Unlocked research skips the dependencies
+	if ((size_t)r->getIndex() >= _unlockedFlags.size() || !_unlockedFlags[r->getIndex()])
 	{
-		return true;
+		for(std::vector<const RuleResearch *>::const_iterator iter = r->getDependencyRules().begin (); iter != r->getDependencyRules().end (); ++iter)
+		{
+			if (!isDiscovered(*iter))
+			{
+				return false;
+			}
+		}
 	}
-	for(std::vector<std::string>::const_iterator iter = deps.begin (); iter != deps.end (); ++ iter)
+	if (isDiscovered(r) && r->getStringTemplate().size() == 0)
 	{
-		RuleResearch *research = ruleset->getResearch(*iter);
-		std::vector<const RuleResearch *>::const_iterator itDiscovered = std::find(discovered.begin (), discovered.end (), research);
-		if (itDiscovered == discovered.end ())
+		return false;
+	}
+	const std::vector<ResearchProject *> & baseResearchProjects = base->getResearch();
+	if (std::find_if (baseResearchProjects.begin(), baseResearchProjects.end (), findRuleResearch(r)) != baseResearchProjects.end ())
+	{
+		return false;
+	}
+	if (r->needItem() && base->getItems()->getItem(r->getName ()) == 0)
+	{
+		return false;
+	}
+	for(std::vector<const RuleResearch *>::const_iterator iter = r->getRequirementRules().begin (); iter != r->getRequirementRules().end (); ++iter)
+	{
+		if (!isDiscovered(*iter))
 		{
 			return false;
 		}
 	}
-
 	return true;
 }
 
@@ -891,23 +1102,17 @@ void SavedGame::getDependableResearch (std::vector<RuleResearch *> & dependables
 */
 void SavedGame::getDependableResearchBasic (std::vector<RuleResearch *> & dependables, const RuleResearch *research, const Ruleset * ruleset, Base * base) const
 {
-	std::vector<RuleResearch *> possibleProjects;
-	getAvailableResearchProjects(possibleProjects, ruleset, base);
-	for(std::vector<RuleResearch *>::iterator iter = possibleProjects.begin (); iter != possibleProjects.end (); ++iter)
+	// Only research depending on or unlocking this one can have become available
+	const std::vector<RuleResearch *> & dependents = research->getDependents();
+	for(std::vector<RuleResearch *>::const_iterator iter = dependents.begin (); iter != dependents.end (); ++iter)
 	{
-		if (std::find((*iter)->getDependencies().begin (), (*iter)->getDependencies().end (), research->getName()) != (*iter)->getDependencies().end ()
-			||
-			std::find((*iter)->getUnlocked().begin (), (*iter)->getUnlocked().end (), research->getName()) != (*iter)->getUnlocked().end ()
-			)
+		if (isResearchAvailable(*iter, base))
 		{
-				dependables.push_back(*iter);
+			dependables.push_back(*iter);
 			if ((*iter)->getCost() == 0)
 			{
 				getDependableResearchBasic(dependables, *iter, ruleset, base);
 			}
-			else
-			{
-			}
 		}
 	}
 }
@@ -1188,20 +1393,6 @@ void SavedGame::setWarned(bool warned)
 	_warned = warned;
 }
 
-/** @brief Check if a point is contained in a region.
- * This function object checks if a point is contained inside a region.
- */
-class ContainsPoint: public std::unary_function<const Region *, bool>
-{
-public:
-	/// Remember the coordinates.
-	ContainsPoint(double lon, double lat) : _lon(lon), _lat(lat) { /* Empty by design. */ }
-	/// Check is the region contains the stored point.
-	bool operator()(const Region *region) const { return region->getRules()->insideRegion(_lon, _lat); }
-private:
-	double _lon, _lat;
-};
-
 /**
  * Find the region containing this location.
  * @param lon The longtitude.
@@ -1210,10 +1401,13 @@ private:
  */
 Region *SavedGame::locateRegion(double lon, double lat) const
 {
-	std::vector<Region *>::const_iterator found = std::find_if(_regions.begin(), _regions.end(), ContainsPoint(lon, lat));
-	if (found != _regions.end())
+	const std::vector<int> &zones = _regionZones.getZones(lon, lat);
+	for (std::vector<int>::const_iterator i = zones.begin(); i != zones.end(); ++i)
 	{
-		return *found;
+		if (_regions[*i]->getRules()->insideRegion(lon, lat))
+		{
+			return _regions[*i];
+		}
 	}
 	return 0;
 }
@@ -1228,6 +1422,55 @@ Region *SavedGame::locateRegion(const Target &target) const
 	return locateRegion(target.getLongitude(), target.getLatitude());
 }
 
+/**
+ * Find the country containing this location.
+ * @param lon The longtitude.
+ * @param lat The latitude.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(double lon, double lat) const
+{
+	const std::vector<int> &zones = _countryZones.getZones(lon, lat);
+	for (std::vector<int>::const_iterator i = zones.begin(); i != zones.end(); ++i)
+	{
+		if (_countries[*i]->getRules()->insideCountry(lon, lat))
+		{
+			return _countries[*i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * Find the country containing this target.
+ * @param target The target to locate.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(const Target &target) const
+{
+	return locateCountry(target.getLongitude(), target.getLatitude());
+}
+
+/**
+ * Builds the spatial index used to locate countries and
+ * regions. Must be called whenever either list changes.
+ */
+void SavedGame::indexZones()
+{
+	_countryZones.clear();
+	for (unsigned int i = 0; i < _countries.size(); ++i)
+	{
+		const RuleCountry *rule = _countries[i]->getRules();
+		_countryZones.addZone(i, rule->getLonMin(), rule->getLonMax(), rule->getLatMin(), rule->getLatMax());
+	}
+	_regionZones.clear();
+	for (unsigned int i = 0; i < _regions.size(); ++i)
+	{
+		const RuleRegion *rule = _regions[i]->getRules();
+		_regionZones.addZone(i, rule->getLonMin(), rule->getLonMax(), rule->getLatMin(), rule->getLatMax());
+	}
+}
+
 /*
  * @return the month counter.
  */
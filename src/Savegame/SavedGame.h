@@ -22,6 +22,8 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <yaml-cpp/yaml.h>
+#include "../Ruleset/ZoneIndex.h"
 
 namespace OpenXcom
 {
@@ -45,6 +47,7 @@ class AlienBase;
 class AlienStrategy;
 class AlienMission;
 class Target;
+class BackgroundWriter;
 
 /**
  * Enumerator containing all the possible game difficulties.
@@ -67,6 +70,7 @@ private:
 	std::map<std::string, int> _ids;
 	std::vector<Country*> _countries;
 	std::vector<Region*> _regions;
+	ZoneIndex _countryZones, _regionZones;
 	std::vector<Base*> _bases;
 	std::vector<Ufo*> _ufos;
 	std::vector<Waypoint*> _waypoints;
@@ -75,12 +79,17 @@ private:
 	AlienStrategy *_alienStrategy;
 	SavedBattleGame *_battleGame;
 	std::vector<const RuleResearch *> _discovered;
+	std::vector<bool> _discoveredFlags, _unlockedFlags;
 	std::vector<AlienMission*> _activeMissions;
 	bool _debug, _warned;
 	int _monthsPassed;
 
+	/// Check whether a ResearchProject has been discovered
+	bool isDiscovered (const RuleResearch * r) const;
+	/// Mark a ResearchProject as discovered
+	void setDiscovered (const RuleResearch * r);
 	/// Check whether a ResearchProject can be researched
-	bool isResearchAvailable (RuleResearch * r, const std::vector<const RuleResearch *> & unlocked, const Ruleset * ruleset) const;
+	bool isResearchAvailable (const RuleResearch * r, Base * base) const;
 	void getDependableResearchBasic (std::vector<RuleResearch *> & dependables, const RuleResearch *research, const Ruleset * ruleset, Base * base) const;
 public:
 	/// Creates a new saved game.
@@ -93,6 +102,12 @@ public:
 	void load(const std::string &filename, Ruleset *rule);
 	/// Saves a saved game to YAML.
 	void save(const std::string &filename) const;
+	/// Saves a saved game to YAML, writing the file in the background.
+	BackgroundWriter *saveBackground(const std::string &filename) const;
+	/// Adds a written save to the save index.
+	void indexSave(const std::string &filename) const;
+	/// Saves a saved game to a YAML emitter.
+	void save(YAML::Emitter &out) const;
 	/// Gets game difficulty.
 	GameDifficulty getDifficulty() const;
 	/// Sets game difficulty.
@@ -197,6 +212,12 @@ public:
 	Region *locateRegion(double lon, double lat) const;
 	/// Locate a region containing a Target.
 	Region *locateRegion(const Target &target) const;
+	/// Locate a country containing a position.
+	Country *locateCountry(double lon, double lat) const;
+	/// Locate a country containing a Target.
+	Country *locateCountry(const Target &target) const;
+	/// Builds the spatial index of countries and regions.
+	void indexZones();
 	/// Return the month counter.
 	int getMonthsPassed() const;
 	/// Increment the month counter.
@@ -27,7 +27,7 @@ namespace OpenXcom
 /**
  * Initializes a target with blank coordinates.
  */
-Target::Target() : _lon(0.0), _lat(0.0), _followers()
+Target::Target() : _lon(0.0), _lat(0.0), _cosLon(1.0), _sinLon(0.0), _cosLat(1.0), _sinLat(0.0), _followers()
 {
 }
 
@@ -41,8 +41,11 @@ Target::~Target()
  */
 void Target::load(const YAML::Node &node)
 {
-	node["lon"] >> _lon;
-	node["lat"] >> _lat;
+	double lon, lat;
+	node["lon"] >> lon;
+	node["lat"] >> lat;
+	setLongitude(lon);
+	setLatitude(lat);
 }
 
 /**
@@ -89,6 +92,9 @@ void Target::setLongitude(double lon)
 		_lon += 2 * M_PI;
 	while (_lon >= 2 * M_PI)
 		_lon -= 2 * M_PI;
+
+	_cosLon = cos(_lon);
+	_sinLon = sin(_lon);
 }
 
 /**
@@ -118,6 +124,9 @@ void Target::setLatitude(double lat)
 		_lat = -M_PI + _lat;
 		setLongitude(_lon - M_PI);
 	}
+
+	_cosLat = cos(_lat);
+	_sinLat = sin(_lat);
 }
 
 /**
@@ -132,13 +141,38 @@ std::vector<Target*> *Target::getFollowers()
 
 /**
  * Returns the great circle distance to another
- * target on the globe.
+ * target on the globe. Uses the sines and cosines
+ * kept for both coordinates, so it only needs one
+ * trigonometric call however often it's checked.
  * @param target Pointer to other target.
  * @returns Distance in radian.
  */
 double Target::getDistance(const Target *target) const
 {
-	return acos(cos(_lat) * cos(target->getLatitude()) * cos(target->getLongitude() - _lon) + sin(_lat) * sin(target->getLatitude()));
+	double cosDistance = _cosLat * target->_cosLat * (_cosLon * target->_cosLon + _sinLon * target->_sinLon) + _sinLat * target->_sinLat;
+	// Rounding can put it slightly outside the valid range
+	if (cosDistance > 1.0)
+		cosDistance = 1.0;
+	else if (cosDistance < -1.0)
+		cosDistance = -1.0;
+	return acos(cosDistance);
+}
+
+/**
+ * Returns the initial heading of the great circle
+ * towards another target, as unnormalized changes
+ * in longitude and latitude.
+ * @param target Pointer to other target.
+ * @param dLon Pointer to the longitude component.
+ * @param dLat Pointer to the latitude component.
+ */
+void Target::getHeading(const Target *target, double *dLon, double *dLat) const
+{
+	// sin and cos of the longitude difference
+	double sinLon = target->_sinLon * _cosLon - target->_cosLon * _sinLon;
+	double cosLon = target->_cosLon * _cosLon + target->_sinLon * _sinLon;
+	*dLon = sinLon * target->_cosLat;
+	*dLat = _cosLat * target->_sinLat - _sinLat * target->_cosLat * cosLon;
 }
 
 }
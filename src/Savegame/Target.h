@@ -36,7 +36,11 @@ class Target
 {
 protected:
 	double _lon, _lat;
+	double _cosLon, _sinLon, _cosLat, _sinLat;
 	std::vector<Target*> _followers;
+
+	/// Gets the heading to another target.
+	void getHeading(const Target *target, double *dLon, double *dLat) const;
 public:
 	/// Creates a target.
 	Target();
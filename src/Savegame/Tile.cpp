@@ -25,6 +25,7 @@
 #include "../Engine/Exception.h"
 #include "BattleUnit.h"
 #include "BattleItem.h"
+#include "SavedBattleGame.h"
 #include "../Ruleset/RuleItem.h"
 #include "../Ruleset/Armor.h"
 
@@ -34,8 +35,9 @@ namespace OpenXcom
 /**
 * constructor
 * @param pos Position.
+* @param save Pointer to the battle the tile is part of, which is told about terrain changes.
 */
-Tile::Tile(const Position& pos): _smoke(0), _fire(0),  _explosive(0), _pos(pos), _unit(0), _animationOffset(0), _markerColor(0), _visible(false)
+Tile::Tile(const Position& pos, SavedBattleGame *save): _smoke(0), _fire(0),  _explosive(0), _pos(pos), _unit(0), _animationOffset(0), _markerColor(0), _visible(false), _terrainVersion(0), _save(save)
 {
 	for (int i = 0; i < 4; ++i)
 	{
@@ -101,24 +103,23 @@ void Tile::load(const YAML::Node &node)
 
 /**
  * Load the tile from binary.
- * @param buffer pointer to buffer.
+ * The record holds the four map data IDs as little endian 16 bit numbers,
+ * then the four map data set IDs, smoke, fire and the discovered flags.
+ * @param buffer pointer to buffer of BINARY_RECORD_SIZE bytes.
  */
 void Tile::loadBinary(const unsigned char* buffer)
 {
-	_mapDataSetID[0] = buffer[4];
-	_mapDataID[0] = buffer[5] + (buffer[6] << 8);
-	_mapDataSetID[1] = buffer[7];
-	_mapDataID[1] = buffer[8] + (buffer[9] << 8);
-	_mapDataSetID[2] = buffer[10];
-	_mapDataID[2] = buffer[11] + (buffer[10] << 8);
-	_mapDataSetID[3] = buffer[13];
-	_mapDataID[3] = buffer[14] + (buffer[15] << 8);
+	for (int part = 0; part < 4; ++part)
+	{
+		_mapDataID[part] = (short)(buffer[part * 2] | (buffer[part * 2 + 1] << 8));
+		_mapDataSetID[part] = (signed char)buffer[8 + part];
+	}
 
-	_smoke = buffer[16];
-	_fire = buffer[17];
-	_discovered[0] = buffer[18] & 1;
-	_discovered[1] = buffer[18] & 2;
-	_discovered[2] = buffer[18] & 4;
+	_smoke = buffer[12];
+	_fire = buffer[13];
+	_discovered[0] = (buffer[14] & 1) != 0;
+	_discovered[1] = (buffer[14] & 2) != 0;
+	_discovered[2] = (buffer[14] & 4) != 0;
 }
 
 
@@ -147,22 +148,20 @@ void Tile::save(YAML::Emitter &out) const
 }
 /**
  * Saves the tile to binary.
- * @param buffer pointer to buffer.
+ * @param buffer pointer to buffer of BINARY_RECORD_SIZE bytes.
  */
 void Tile::saveBinary(unsigned char* buffer) const
 {
-	buffer[4] = (unsigned char)_mapDataSetID[0];
-	buffer[5] = (unsigned short)_mapDataID[0];
-	buffer[7] = (unsigned char)_mapDataSetID[1];
-	buffer[8] = (unsigned short)_mapDataID[1];
-	buffer[10] = (unsigned char)_mapDataSetID[2];
-	buffer[11] = (unsigned short)_mapDataID[2];
-	buffer[13] = (unsigned char)_mapDataSetID[3];
-	buffer[14] = (unsigned short)_mapDataID[3];
+	for (int part = 0; part < 4; ++part)
+	{
+		buffer[part * 2] = (unsigned char)(_mapDataID[part] & 0xFF);
+		buffer[part * 2 + 1] = (unsigned char)((_mapDataID[part] >> 8) & 0xFF);
+		buffer[8 + part] = (unsigned char)_mapDataSetID[part];
+	}
 
-	buffer[16] = (unsigned short)_smoke;
-	buffer[17] = (unsigned short)_fire;
-	buffer[18] = (_discovered[0]?1:0) + (_discovered[1]?1:0) << 1 + (_discovered[2]?1:0) << 2;
+	buffer[12] = (unsigned char)_smoke;
+	buffer[13] = (unsigned char)_fire;
+	buffer[14] = (_discovered[0]?1:0) | (_discovered[1]?2:0) | (_discovered[2]?4:0);
 }
 
 /**
@@ -190,6 +189,7 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, int part)
 	_objects[part] = dat;
 	_mapDataID[part] = mapDataID;
 	_mapDataSetID[part] = mapDataSetID;
+	terrainChanged();
 }
 
 /**
@@ -320,6 +320,7 @@ int Tile::openDoor(int part, BattleUnit *unit, bool debug)
 		if (unit && unit->getTimeUnits() < _objects[part]->getTUCost(unit->getArmor()->getMovementType()) && !debug)
 			return 4;
 		_currentFrame[part] = 1; // start opening door
+		terrainChanged();
 		return 1;
 	}
 	if (_objects[part]->isUFODoor() && _currentFrame[part] != 7) // ufo door != part 7 - door is still opening
@@ -357,6 +358,11 @@ int Tile::closeUfoDoor()
 		}
 	}
 
+	if (retval)
+	{
+		terrainChanged();
+	}
+
 	return retval;
 }
 
@@ -538,7 +544,7 @@ bool Tile::detonate()
 		int flam = getFlammability();
 		if (flam <= 20)
 		{
-			if (RNG::generate(0, 20) - flam >= 0)
+			if (RNG::generate(RNG::BATTLESCAPE, 0, 20) - flam >= 0)
 			{
 				ignite();
 			}
@@ -598,10 +604,12 @@ void Tile::ignite()
  * Animate the tile. This means to advance the current frame for every object.
  * Ufo doors are a bit special, they animated only when triggered.
  * When ufo doors are on frame 0(closed) or frame 7(open) they are not animated further.
+ * A ufo door leaving frame 1 stops costing TUs, so that counts as a terrain change.
  */
 void Tile::animate()
 {
 	int newframe;
+	bool changed = false;
 	for (int i=0; i < 4; ++i)
 	{
 		if (_objects[i])
@@ -610,6 +618,10 @@ void Tile::animate()
 			{
 				continue;
 			}
+			if (_objects[i]->isUFODoor() && _currentFrame[i] == 1)
+			{
+				changed = true;
+			}
 			newframe = _currentFrame[i] + 1;
 			if (newframe == 8)
 			{
@@ -618,6 +630,10 @@ void Tile::animate()
 			_currentFrame[i] = newframe;
 		}
 	}
+	if (changed)
+	{
+		terrainChanged();
+	}
 }
 
 /**
@@ -662,7 +678,7 @@ BattleUnit *Tile::getUnit() const
 void Tile::setFire(int fire)
 {
 	_fire = fire;
-	_animationOffset = RNG::generate(0,3);
+	_animationOffset = RNG::generate(RNG::BATTLESCAPE, 0,3);
 }
 
 /**
@@ -682,7 +698,7 @@ void Tile::addSmoke(int smoke)
 {
 	_smoke += smoke;
 	if (_smoke > 40) _smoke = 40;
-	_animationOffset = RNG::generate(0,3);
+	_animationOffset = RNG::generate(RNG::BATTLESCAPE, 0,3);
 }
 
 /**
@@ -838,4 +854,27 @@ int Tile::getVisible()
 	return _visible;
 }
 
+/**
+ * Increases the terrain version of this tile and adds it to the battle's log of terrain changes.
+ */
+void Tile::terrainChanged()
+{
+	++_terrainVersion;
+	if (_save)
+	{
+		_save->terrainChanged(this);
+	}
+}
+
+/**
+ * Get the terrain version of this tile. It is increased every time a part of the tile
+ * is replaced or destroyed, or a ufo door opens or closes, so cached terrain data can
+ * tell when it has gone stale.
+ * @return terrain version
+ */
+int Tile::getTerrainVersion() const
+{
+	return _terrainVersion;
+}
+
 }
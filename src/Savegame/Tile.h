@@ -34,6 +34,7 @@ class MapData;
 class BattleUnit;
 class BattleItem;
 class RuleInventory;
+class SavedBattleGame;
 
 /**
  * Basic element of which a battle map is build.
@@ -58,13 +59,18 @@ protected:
 	int _animationOffset;
 	int _markerColor;
 	int _visible;
+	int _terrainVersion;
+	SavedBattleGame *_save;
+	void terrainChanged();
 public:
+	static const int BINARY_RECORD_SIZE = 15;
 	/// Creates a tile.
-	Tile(const Position& pos);
+	Tile(const Position& pos, SavedBattleGame *save);
 	/// Cleans up a tile.
 	~Tile();
 	/// Load the tile to yaml
 	void load(const YAML::Node &node);
+	/// Load the tile from binary
 	void loadBinary(const unsigned char* buffer);
 	/// Saves the tile to yaml
 	void save(YAML::Emitter &out) const;
@@ -156,6 +162,8 @@ public:
 	void setVisible(int visibility);
 	/// Get the tile visible flag.
 	int getVisible();
+	/// Get the terrain version, which changes every time the terrain or doors on this tile change.
+	int getTerrainVersion() const;
 
 };
 
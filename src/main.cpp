@@ -40,6 +40,7 @@
 using namespace OpenXcom;
 
 Game *game = 0;
+bool benchmark = false;
 
 // If you can't tell what the main() is for you should have your
 // programming license revoked...
@@ -54,6 +55,13 @@ int main(int argc, char** args)
 #endif
 		if (!Options::init(argc, args))
 			return EXIT_SUCCESS;
+		benchmark = (Options::getBenchmarkSave() != "");
+		if (benchmark)
+		{
+			// Benchmarks run without a display or sound
+			SDL_putenv("SDL_VIDEODRIVER=dummy");
+			Options::setBool("mute", true);
+		}
 		game = new Game("OpenXcom " + Options::getVersion());
 		game->setVolume(Options::getInt("soundVolume"), Options::getInt("musicVolume"));
 		game->setState(new StartState(game));
@@ -66,7 +74,11 @@ int main(int argc, char** args)
 		exit(EXIT_FAILURE);
 	}
 #endif
-	Options::save();
+	// Benchmark settings aren't meant to stick
+	if (!benchmark)
+	{
+		Options::save();
+	}
 
 	// Comment this for faster exit.
 	delete game;